@@ -0,0 +1,432 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ConcurrentHashTable is a thread-safe hash set split into independent stripes. Every value maps
+// to one stripe, an open addressing table with linear probing whose slots hold atomic pointers to
+// immutable nodes. Writers of a stripe are serialized by its mutex and publish nodes and rebuilt
+// slot arrays with release stores, so lookups take no lock and only use acquire loads. Removed
+// nodes and replaced slot arrays are freed by epoch-based reclamation once no lookup that could
+// still see them is running. Stripes are cache line aligned to avoid false sharing.
+template <typename T, typename Hash = std::hash<T>>
+class ConcurrentHashTable
+{
+public:
+    ConcurrentHashTable(std::size_t slots, std::size_t stripes = defaultStripes());
+    ConcurrentHashTable() = delete;
+    ConcurrentHashTable(const ConcurrentHashTable<T, Hash>& other) = delete;
+    ConcurrentHashTable<T, Hash>& operator=(const ConcurrentHashTable<T, Hash>& other) = delete;
+    ~ConcurrentHashTable();
+
+    auto size() const -> std::size_t;
+    auto stripeCnt() const -> std::size_t { return stripeMask_ + 1; }
+    bool contains(const T& value) const;
+    void insert(const T& value);
+    void remove(const T& value);
+    void reserve(std::size_t count);
+    auto print() const -> std::string;
+
+private:
+    // Smallest slot array of a stripe.
+    static constexpr std::size_t MIN_CAPACITY = 16;
+    // Removed nodes are freed in batches, each batch waits for one epoch change.
+    static constexpr std::size_t RECLAIM_BATCH = 128;
+    // Lookups register in one of these counters, picked per thread to spread the contention.
+    static constexpr std::size_t READER_SLOTS = 64;
+
+    struct Node
+    {
+        std::size_t hash;
+        T value;
+    };
+
+    struct Slots
+    {
+        explicit Slots(std::size_t capacity);
+
+        auto index(std::size_t hash) const -> std::size_t;
+
+        std::size_t capacity;
+        int shift = 64;
+        std::unique_ptr<std::atomic<Node*>[]> slots;
+    };
+
+    struct alignas(64) Stripe
+    {
+        std::mutex mutex;
+        std::atomic<Slots*> slots;
+        std::atomic<std::size_t> size = 0;
+        std::size_t used = 0; // values and deleted slots, guarded by the mutex
+        std::vector<Node*> retiredNodes;
+        std::vector<Slots*> retiredSlots;
+    };
+
+    // Counts of running lookups that started in an even and in an odd epoch.
+    struct alignas(64) Readers
+    {
+        std::atomic<std::size_t> active[2] = {};
+    };
+
+    // Lookups are registered in the current epoch for as long as the guard lives.
+    class ReadGuard
+    {
+    public:
+        explicit ReadGuard(const ConcurrentHashTable<T, Hash>& table);
+        ReadGuard(const ReadGuard& other) = delete;
+        ReadGuard& operator=(const ReadGuard& other) = delete;
+        ~ReadGuard();
+
+    private:
+        std::atomic<std::size_t>* counter_;
+    };
+
+    std::vector<std::unique_ptr<Stripe>> stripes_;
+    std::size_t stripeMask_ = 0;
+    Hash hasher_;
+
+    mutable Readers readers_[READER_SLOTS];
+    std::atomic<std::uint64_t> epoch_ = 0;
+    std::mutex epochMutex_;
+
+    // Marks a deleted slot, never dereferenced.
+    alignas(Node) static inline unsigned char deletedMarker_[sizeof(Node)] = {};
+
+    static auto defaultStripes() -> std::size_t;
+    static auto deleted() -> Node* { return reinterpret_cast<Node*>(deletedMarker_); }
+    static auto readerIndex() -> std::size_t;
+    static auto capacityFor(std::size_t count) -> std::size_t;
+    auto stripe(std::size_t hash) const -> Stripe&;
+    void rebuild(Stripe& s, std::size_t capacity);
+    void reclaim(Stripe& s);
+    void synchronize();
+};
+
+template <typename T, typename Hash>
+ConcurrentHashTable<T, Hash>::Slots::Slots(std::size_t capacity) : capacity(capacity), slots(new std::atomic<Node*>[capacity])
+{
+    for (std::size_t c = capacity; c > 1; c /= 2)
+        --shift;
+
+    for (std::size_t i = 0; i < capacity; ++i)
+        slots[i].store(nullptr, std::memory_order_relaxed);
+}
+
+// Fibonacci hashing takes the top bits, which depend on all bits of the hash.
+template <typename T, typename Hash>
+auto ConcurrentHashTable<T, Hash>::Slots::index(std::size_t hash) const -> std::size_t
+{
+    const std::uint64_t h = static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+    return shift == 64 ? 0 : static_cast<std::size_t>(h >> shift);
+}
+
+// A lookup first increments the counter of the epoch it read. If the epoch changed in between, the
+// writer waiting for that epoch may have already checked the counter, so the lookup starts over.
+template <typename T, typename Hash>
+ConcurrentHashTable<T, Hash>::ReadGuard::ReadGuard(const ConcurrentHashTable<T, Hash>& table)
+{
+    auto& readers = table.readers_[readerIndex()];
+
+    while (true)
+    {
+        const auto epoch = table.epoch_.load();
+        counter_ = &readers.active[epoch & 1];
+        counter_->fetch_add(1);
+
+        if (table.epoch_.load() == epoch)
+            return;
+
+        counter_->fetch_sub(1, std::memory_order_release);
+    }
+}
+
+template <typename T, typename Hash>
+ConcurrentHashTable<T, Hash>::ReadGuard::~ReadGuard()
+{
+    counter_->fetch_sub(1, std::memory_order_release);
+}
+
+template <typename T, typename Hash>
+ConcurrentHashTable<T, Hash>::ConcurrentHashTable(std::size_t slots, std::size_t stripes)
+{
+    std::size_t count = 1;
+    while (count < stripes)
+        count *= 2;
+
+    stripeMask_ = count - 1;
+    stripes_.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        stripes_.push_back(std::make_unique<Stripe>());
+        stripes_.back()->slots.store(new Slots(capacityFor(slots / count)), std::memory_order_relaxed);
+    }
+}
+
+template <typename T, typename Hash>
+ConcurrentHashTable<T, Hash>::~ConcurrentHashTable()
+{
+    for (auto& s : stripes_)
+    {
+        Slots* slots = s->slots.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < slots->capacity; ++i)
+        {
+            Node* node = slots->slots[i].load(std::memory_order_relaxed);
+            if (node != nullptr && node != deleted())
+                delete node;
+        }
+
+        delete slots;
+        for (Node* node : s->retiredNodes)
+            delete node;
+        for (Slots* retired : s->retiredSlots)
+            delete retired;
+    }
+}
+
+// The stripe is chosen from the top bits of a different multiplicative hash than the one used
+// for the slots, so the values of one stripe are still spread over the whole slot array.
+template <typename T, typename Hash>
+auto ConcurrentHashTable<T, Hash>::stripe(std::size_t hash) const -> Stripe&
+{
+    const std::uint64_t h = static_cast<std::uint64_t>(hash) * 0xC2B2AE3D27D4EB4Full;
+    return *stripes_[(h >> 40) & stripeMask_];
+}
+
+// Several stripes per core keep the chance of two writers hitting the same stripe low.
+template <typename T, typename Hash>
+auto ConcurrentHashTable<T, Hash>::defaultStripes() -> std::size_t
+{
+    return std::max(std::thread::hardware_concurrency(), 1u) * 4;
+}
+
+template <typename T, typename Hash>
+auto ConcurrentHashTable<T, Hash>::readerIndex() -> std::size_t
+{
+    static std::atomic<std::size_t> next = 0;
+    thread_local const std::size_t index = next.fetch_add(1, std::memory_order_relaxed) % READER_SLOTS;
+    return index;
+}
+
+// Slot arrays are rebuilt at most half full, which leaves room for as many inserts before the next
+// rebuild at the maximum load of 3/4.
+template <typename T, typename Hash>
+auto ConcurrentHashTable<T, Hash>::capacityFor(std::size_t count) -> std::size_t
+{
+    std::size_t capacity = MIN_CAPACITY;
+    while (capacity < 2 * count + 1)
+        capacity *= 2;
+
+    return capacity;
+}
+
+template <typename T, typename Hash>
+auto ConcurrentHashTable<T, Hash>::size() const -> std::size_t
+{
+    std::size_t size = 0;
+
+    for (const auto& s : stripes_)
+        size += s->size.load(std::memory_order_relaxed);
+
+    return size;
+}
+
+// Nodes are never modified after they are published, and neither they nor the slot array can be
+// freed while the guard keeps this lookup registered in its epoch.
+template <typename T, typename Hash>
+bool ConcurrentHashTable<T, Hash>::contains(const T& value) const
+{
+    const auto hash = hasher_(value);
+    auto& s = stripe(hash);
+    ReadGuard guard(*this);
+
+    const Slots* slots = s.slots.load(std::memory_order_acquire);
+    const auto mask = slots->capacity - 1;
+
+    for (std::size_t i = slots->index(hash), probes = 0; probes < slots->capacity; i = (i + 1) & mask, ++probes)
+    {
+        const Node* node = slots->slots[i].load(std::memory_order_acquire);
+        if (node == nullptr)
+            return false;
+        if (node != deleted() && node->hash == hash && node->value == value)
+            return true;
+    }
+
+    return false;
+}
+
+// The value goes to the first deleted slot of its probe sequence or to the empty slot that ends it.
+// Deleted slots count towards the load, so a rebuild also clears them.
+template <typename T, typename Hash>
+void ConcurrentHashTable<T, Hash>::insert(const T& value)
+{
+    const auto hash = hasher_(value);
+    auto& s = stripe(hash);
+    std::lock_guard lock(s.mutex);
+
+    Slots* slots = s.slots.load(std::memory_order_relaxed);
+    if ((s.used + 1) * 4 > slots->capacity * 3)
+    {
+        rebuild(s, capacityFor(s.size.load(std::memory_order_relaxed) + 1));
+        slots = s.slots.load(std::memory_order_relaxed);
+    }
+
+    const auto mask = slots->capacity - 1;
+    auto target = slots->capacity;
+    auto i = slots->index(hash);
+
+    for (;; i = (i + 1) & mask)
+    {
+        const Node* node = slots->slots[i].load(std::memory_order_relaxed);
+        if (node == nullptr)
+            break;
+        if (node == deleted())
+        {
+            if (target == slots->capacity)
+                target = i;
+        }
+        else if (node->hash == hash && node->value == value)
+            return;
+    }
+
+    if (target == slots->capacity)
+    {
+        target = i;
+        ++s.used;
+    }
+
+    slots->slots[target].store(new Node{ hash, value }, std::memory_order_release);
+    s.size.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename T, typename Hash>
+void ConcurrentHashTable<T, Hash>::remove(const T& value)
+{
+    const auto hash = hasher_(value);
+    auto& s = stripe(hash);
+    std::lock_guard lock(s.mutex);
+
+    Slots* slots = s.slots.load(std::memory_order_relaxed);
+    const auto mask = slots->capacity - 1;
+
+    for (auto i = slots->index(hash);; i = (i + 1) & mask)
+    {
+        Node* node = slots->slots[i].load(std::memory_order_relaxed);
+        if (node == nullptr)
+            return;
+
+        if (node != deleted() && node->hash == hash && node->value == value)
+        {
+            slots->slots[i].store(deleted(), std::memory_order_release);
+            s.size.fetch_sub(1, std::memory_order_relaxed);
+            s.retiredNodes.push_back(node);
+
+            if (s.retiredNodes.size() >= RECLAIM_BATCH)
+                reclaim(s);
+            return;
+        }
+    }
+}
+
+template <typename T, typename Hash>
+void ConcurrentHashTable<T, Hash>::reserve(std::size_t count)
+{
+    const auto capacity = capacityFor(count / stripeCnt() + 1);
+
+    for (auto& s : stripes_)
+    {
+        std::lock_guard lock(s->mutex);
+        if (s->slots.load(std::memory_order_relaxed)->capacity < capacity)
+            rebuild(*s, capacity);
+    }
+}
+
+template <typename T, typename Hash>
+auto ConcurrentHashTable<T, Hash>::print() const -> std::string
+{
+    std::stringstream out;
+
+    for (std::size_t i = 0; i <= stripeMask_; ++i)
+    {
+        auto& s = *stripes_[i];
+        std::lock_guard lock(s.mutex);
+        const Slots* slots = s.slots.load(std::memory_order_relaxed);
+
+        out << "stripe " << i << "\n";
+        for (std::size_t j = 0; j < slots->capacity; ++j)
+        {
+            const Node* node = slots->slots[j].load(std::memory_order_relaxed);
+            out << j << ": ";
+            if (node != nullptr && node != deleted())
+                out << node->value;
+            out << "\n";
+        }
+    }
+
+    return out.str();
+}
+
+// The nodes move to the new slot array as they are, only the array is published and retired.
+// Lookups still probing the old array find the same nodes there.
+template <typename T, typename Hash>
+void ConcurrentHashTable<T, Hash>::rebuild(Stripe& s, std::size_t capacity)
+{
+    Slots* old = s.slots.load(std::memory_order_relaxed);
+    auto slots = std::make_unique<Slots>(capacity);
+    const auto mask = capacity - 1;
+
+    for (std::size_t i = 0; i < old->capacity; ++i)
+    {
+        Node* node = old->slots[i].load(std::memory_order_relaxed);
+        if (node == nullptr || node == deleted())
+            continue;
+
+        auto j = slots->index(node->hash);
+        while (slots->slots[j].load(std::memory_order_relaxed) != nullptr)
+            j = (j + 1) & mask;
+        slots->slots[j].store(node, std::memory_order_relaxed);
+    }
+
+    s.slots.store(slots.release(), std::memory_order_release);
+    s.used = s.size.load(std::memory_order_relaxed);
+    s.retiredSlots.push_back(old);
+    reclaim(s);
+}
+
+template <typename T, typename Hash>
+void ConcurrentHashTable<T, Hash>::reclaim(Stripe& s)
+{
+    synchronize();
+
+    for (Node* node : s.retiredNodes)
+        delete node;
+    for (Slots* slots : s.retiredSlots)
+        delete slots;
+
+    s.retiredNodes.clear();
+    s.retiredSlots.clear();
+}
+
+// Waits until every lookup that started before the call has finished. Lookups register in the
+// parity of the epoch they started in and a new one cannot start in the old epoch once it is
+// advanced, so the old counters only go down. Everything retired before the call is then unreachable.
+template <typename T, typename Hash>
+void ConcurrentHashTable<T, Hash>::synchronize()
+{
+    std::lock_guard lock(epochMutex_);
+    const auto parity = epoch_.fetch_add(1) & 1;
+
+    for (auto& readers : readers_)
+    {
+        while (readers.active[parity].load() != 0)
+            std::this_thread::yield();
+    }
+}
@@ -1,23 +1,440 @@
 #pragma once
 
-#include <list>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <sstream>
+#include <stdexcept>
 #include <string>
-#include <vector>
+#include <utility>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// HashTable is an open addressing hash set in the style of SwissTable. Every slot has a one byte
+// control word which marks the slot as empty, deleted or holds the low 7 bits of the key's hash.
+// Slots are split into groups of GROUP_SIZE and the control words of a whole group are matched
+// against the hash at once (SSE2 if available), so a lookup usually reads one group of metadata
+// and compares only the keys whose 7 hash bits match. Groups are probed quadratically.
+//
+// When the load factor would exceed the maximum, a new table is allocated and the old one is
+// migrated incrementally: every insert or remove moves MIGRATION_GROUPS groups, and lookups
+// consult both tables until the migration is finished. reserve() and rehash() are explicit
+// requests and complete immediately.
+template <typename T, typename Hash = std::hash<T>>
 class HashTable
 {
 public:
-    HashTable(int slots);
+    HashTable(std::size_t slots);
     HashTable() = delete;
 
-    bool contains(int value) const;
-    void insert(int value);
-    void remove(int value);
+    bool empty() const { return size() == 0; }
+    auto size() const -> std::size_t { return table_.size + old_.size; }
+    auto capacity() const -> std::size_t { return table_.capacity; }
+    auto loadFactor() const -> float { return static_cast<float>(size()) / capacity(); }
+    auto maxLoadFactor() const -> float { return maxLoadFactor_; }
+    void setMaxLoadFactor(float loadFactor);
+    bool isRehashing() const { return old_.capacity != 0; }
+    void reserve(std::size_t count);
+    void rehash(std::size_t slots);
+
+    bool contains(const T& value) const;
+    void insert(const T& value);
+    void remove(const T& value);
     auto print() const -> std::string;
 
 private:
-    const int slots_;
-    std::vector<std::list<int>> table_;
+    static constexpr std::size_t GROUP_SIZE = 16;
+    static constexpr std::size_t MIGRATION_GROUPS = 2;
+    static constexpr std::int8_t EMPTY = -128;
+    static constexpr std::int8_t DELETED = -2;
+
+    struct Table
+    {
+        std::int8_t* ctrl = nullptr;
+        T* slots = nullptr;
+
+        std::size_t capacity = 0; // always a power of two number of groups
+        std::size_t size = 0;
+        std::size_t deleted = 0;
+
+        Table() = default;
+        explicit Table(std::size_t slots);
+        Table(const Table& other);
+        Table(Table&& other) noexcept;
+        Table& operator=(Table other) noexcept;
+        ~Table();
+
+        friend void swap(Table& lhs, Table& rhs) noexcept
+        {
+            using std::swap;
+            swap(lhs.ctrl, rhs.ctrl);
+            swap(lhs.slots, rhs.slots);
+            swap(lhs.capacity, rhs.capacity);
+            swap(lhs.size, rhs.size);
+            swap(lhs.deleted, rhs.deleted);
+        }
 
-    int getHash(int key) const;
+        auto match(std::size_t group, std::int8_t h2) const -> std::uint32_t;
+        auto matchAvailable(std::size_t group) const -> std::uint32_t;
+        auto find(const T& value, std::uint64_t hash) const -> std::size_t;
+        void place(T&& value, std::uint64_t hash);
+        void erase(std::size_t idx);
+    };
+
+    Table table_;
+    Table old_;
+    std::size_t migrated_ = 0; // groups of the old table already moved
+    float maxLoadFactor_ = 0.875f;
+    Hash hasher_;
+
+    auto hash(const T& value) const -> std::uint64_t;
+    auto slotsFor(std::size_t count) const -> std::size_t;
+    void grow();
+    void startMigration(std::size_t slots);
+    void migrate(std::size_t groups);
+    static auto lowestBit(std::uint32_t mask) -> std::size_t;
 };
+
+template <typename T, typename Hash>
+HashTable<T, Hash>::Table::Table(std::size_t slots)
+{
+    std::size_t groups = 1;
+    while (groups * GROUP_SIZE < slots)
+        groups *= 2;
+
+    capacity = groups * GROUP_SIZE;
+    ctrl = new std::int8_t[capacity];
+    this->slots = (T*)::operator new(capacity * sizeof(T));
+
+    for (std::size_t i = 0; i < capacity; ++i)
+        ctrl[i] = EMPTY;
+}
+
+template <typename T, typename Hash>
+HashTable<T, Hash>::Table::Table(const Table& other) :
+    ctrl(other.capacity != 0 ? new std::int8_t[other.capacity] : nullptr),
+    slots(other.capacity != 0 ? (T*)::operator new(other.capacity * sizeof(T)) : nullptr),
+    capacity(other.capacity),
+    size(other.size),
+    deleted(other.deleted)
+{
+    for (std::size_t i = 0; i < capacity; ++i)
+    {
+        ctrl[i] = other.ctrl[i];
+        if (ctrl[i] >= 0)
+            new (&slots[i]) T(other.slots[i]);
+    }
+}
+
+template <typename T, typename Hash>
+HashTable<T, Hash>::Table::Table(Table&& other) noexcept
+{
+    swap(*this, other);
+}
+
+template <typename T, typename Hash>
+auto HashTable<T, Hash>::Table::operator=(Table other) noexcept -> Table&
+{
+    swap(*this, other);
+    return *this;
+}
+
+template <typename T, typename Hash>
+HashTable<T, Hash>::Table::~Table()
+{
+    for (std::size_t i = 0; i < capacity; ++i)
+    {
+        if (ctrl[i] >= 0)
+            slots[i].~T();
+    }
+
+    delete[] ctrl;
+    ::operator delete(slots, capacity * sizeof(T));
+}
+
+template <typename T, typename Hash>
+auto HashTable<T, Hash>::Table::match(std::size_t group, std::int8_t h2) const -> std::uint32_t
+{
+    const std::int8_t* data = ctrl + group * GROUP_SIZE;
+#ifdef __SSE2__
+    const auto loaded = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), loaded)));
+#else
+    std::uint32_t mask = 0;
+    for (std::size_t i = 0; i < GROUP_SIZE; ++i)
+        mask |= static_cast<std::uint32_t>(data[i] == h2) << i;
+    return mask;
+#endif
+}
+
+// Empty and deleted control words are the only negative ones, so the sign bits are the mask.
+template <typename T, typename Hash>
+auto HashTable<T, Hash>::Table::matchAvailable(std::size_t group) const -> std::uint32_t
+{
+    const std::int8_t* data = ctrl + group * GROUP_SIZE;
+#ifdef __SSE2__
+    const auto loaded = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(loaded));
+#else
+    std::uint32_t mask = 0;
+    for (std::size_t i = 0; i < GROUP_SIZE; ++i)
+        mask |= static_cast<std::uint32_t>(data[i] < 0) << i;
+    return mask;
+#endif
+}
+
+// Return the slot index of the value or capacity if the value is not present.
+// The probe ends at the first group with an empty slot since an insertion would have stopped there.
+template <typename T, typename Hash>
+auto HashTable<T, Hash>::Table::find(const T& value, std::uint64_t hash) const -> std::size_t
+{
+    if (capacity == 0)
+        return capacity;
+
+    const auto h2 = static_cast<std::int8_t>(hash & 0x7F);
+    const std::size_t groupMask = capacity / GROUP_SIZE - 1;
+    std::size_t group = (hash >> 7) & groupMask;
+
+    for (std::size_t step = 1; step <= groupMask + 1; ++step)
+    {
+        for (auto mask = match(group, h2); mask != 0; mask &= mask - 1)
+        {
+            const auto idx = group * GROUP_SIZE + lowestBit(mask);
+            if (slots[idx] == value)
+                return idx;
+        }
+
+        if (match(group, EMPTY) != 0)
+            break;
+
+        group = (group + step) & groupMask;
+    }
+
+    return capacity;
+}
+
+// Put a value known to be absent into the first available slot of its probe sequence.
+template <typename T, typename Hash>
+void HashTable<T, Hash>::Table::place(T&& value, std::uint64_t hash)
+{
+    const std::size_t groupMask = capacity / GROUP_SIZE - 1;
+    std::size_t group = (hash >> 7) & groupMask;
+
+    for (std::size_t step = 1; step <= groupMask + 1; ++step)
+    {
+        if (auto mask = matchAvailable(group); mask != 0)
+        {
+            const auto idx = group * GROUP_SIZE + lowestBit(mask);
+            new (&slots[idx]) T(std::move(value));
+            deleted -= ctrl[idx] == DELETED;
+            ctrl[idx] = static_cast<std::int8_t>(hash & 0x7F);
+            ++size;
+            return;
+        }
+
+        group = (group + step) & groupMask;
+    }
+
+    throw std::runtime_error("Hash table overflow");
+}
+
+// A removed slot can become empty again only if its group already has an empty slot,
+// otherwise a probe could stop early and miss a value placed further down the sequence.
+template <typename T, typename Hash>
+void HashTable<T, Hash>::Table::erase(std::size_t idx)
+{
+    slots[idx].~T();
+    --size;
+
+    if (match(idx / GROUP_SIZE, EMPTY) != 0)
+    {
+        ctrl[idx] = EMPTY;
+    }
+    else
+    {
+        ctrl[idx] = DELETED;
+        ++deleted;
+    }
+}
+
+template <typename T, typename Hash>
+HashTable<T, Hash>::HashTable(std::size_t slots) : table_(slots)
+{
+    assert(slots > 0 && "Invalid number of slots");
+}
+
+template <typename T, typename Hash>
+void HashTable<T, Hash>::setMaxLoadFactor(float loadFactor)
+{
+    if (loadFactor <= 0 || loadFactor >= 1)
+        throw std::runtime_error("Invalid load factor");
+
+    maxLoadFactor_ = loadFactor;
+
+    if (table_.size + table_.deleted > table_.capacity * maxLoadFactor_)
+        grow();
+}
+
+// Make room for count values without triggering another rehash.
+template <typename T, typename Hash>
+void HashTable<T, Hash>::reserve(std::size_t count)
+{
+    if (slotsFor(count) > capacity())
+        rehash(slotsFor(count));
+}
+
+// Rebuild the table with at least the given number of slots (or more if the values would not fit)
+// and finish the migration right away. This also drops all deleted slots.
+template <typename T, typename Hash>
+void HashTable<T, Hash>::rehash(std::size_t slots)
+{
+    startMigration(std::max(slots, slotsFor(size())));
+    migrate(old_.capacity / GROUP_SIZE);
+}
+
+template <typename T, typename Hash>
+bool HashTable<T, Hash>::contains(const T& value) const
+{
+    const auto h = hash(value);
+    return table_.find(value, h) != table_.capacity || old_.find(value, h) != old_.capacity;
+}
+
+template <typename T, typename Hash>
+void HashTable<T, Hash>::insert(const T& value)
+{
+    const auto h = hash(value);
+    if (table_.find(value, h) != table_.capacity || old_.find(value, h) != old_.capacity)
+        return;
+
+    migrate(MIGRATION_GROUPS);
+
+    if (table_.size + table_.deleted + 1 > table_.capacity * maxLoadFactor_)
+        grow();
+
+    table_.place(T(value), h);
+}
+
+template <typename T, typename Hash>
+void HashTable<T, Hash>::remove(const T& value)
+{
+    const auto h = hash(value);
+
+    if (auto idx = table_.find(value, h); idx != table_.capacity)
+        table_.erase(idx);
+    else if (auto oldIdx = old_.find(value, h); oldIdx != old_.capacity)
+        old_.erase(oldIdx);
+
+    migrate(MIGRATION_GROUPS);
+}
+
+template <typename T, typename Hash>
+auto HashTable<T, Hash>::print() const -> std::string
+{
+    std::stringstream out;
+
+    for (std::size_t i = 0; i < table_.capacity; ++i)
+    {
+        out << i << ": ";
+        if (table_.ctrl[i] >= 0)
+            out << table_.slots[i];
+        out << "\n";
+    }
+
+    if (isRehashing())
+    {
+        out << "rehashing " << migrated_ * GROUP_SIZE << "/" << old_.capacity << "\n";
+        for (std::size_t i = migrated_ * GROUP_SIZE; i < old_.capacity; ++i)
+        {
+            if (old_.ctrl[i] >= 0)
+                out << i << ": " << old_.slots[i] << "\n";
+        }
+    }
+
+    return out.str();
+}
+
+// Standard hashers are often identity for integers, so the hash is scrambled by a multiplicative
+// step. The low 7 bits (h2) are stored in the control word, the rest (h1) selects the first group.
+template <typename T, typename Hash>
+auto HashTable<T, Hash>::hash(const T& value) const -> std::uint64_t
+{
+    std::uint64_t h = static_cast<std::uint64_t>(hasher_(value)) * 0x9E3779B97F4A7C15ull;
+    return h ^ (h >> 32);
+}
+
+template <typename T, typename Hash>
+auto HashTable<T, Hash>::slotsFor(std::size_t count) const -> std::size_t
+{
+    return static_cast<std::size_t>(count / maxLoadFactor_) + 1;
+}
+
+// Double the capacity, unless most of the used slots are deleted ones. In that case the table
+// is rebuilt with the same capacity just to get rid of them.
+template <typename T, typename Hash>
+void HashTable<T, Hash>::grow()
+{
+    const bool mostlyDeleted = size() * 2 < table_.capacity * maxLoadFactor_;
+    startMigration(mostlyDeleted ? table_.capacity : table_.capacity * 2);
+}
+
+// The current table becomes the old one and is drained into a fresh table by migrate().
+// A migration still in progress is finished first, so at most two tables exist at a time.
+template <typename T, typename Hash>
+void HashTable<T, Hash>::startMigration(std::size_t slots)
+{
+    migrate(old_.capacity / GROUP_SIZE);
+
+    old_ = std::move(table_);
+    table_ = Table(slots);
+    migrated_ = 0;
+}
+
+// Moved values are marked as deleted rather than empty so that probes in the old table keep
+// walking past the already migrated groups.
+template <typename T, typename Hash>
+void HashTable<T, Hash>::migrate(std::size_t groups)
+{
+    if (!isRehashing())
+        return;
+
+    const std::size_t oldGroups = old_.capacity / GROUP_SIZE;
+    const std::size_t end = std::min(oldGroups, migrated_ + groups);
+
+    for (; migrated_ < end; ++migrated_)
+    {
+        for (std::size_t idx = migrated_ * GROUP_SIZE; idx < (migrated_ + 1) * GROUP_SIZE; ++idx)
+        {
+            if (old_.ctrl[idx] < 0)
+                continue;
+
+            const auto h = hash(old_.slots[idx]);
+            table_.place(std::move(old_.slots[idx]), h);
+            old_.slots[idx].~T();
+            old_.ctrl[idx] = DELETED;
+            --old_.size;
+        }
+    }
+
+    if (migrated_ == oldGroups)
+    {
+        old_ = Table();
+        migrated_ = 0;
+    }
+}
+
+template <typename T, typename Hash>
+auto HashTable<T, Hash>::lowestBit(std::uint32_t mask) -> std::size_t
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<std::size_t>(__builtin_ctz(mask));
+#else
+    std::size_t idx = 0;
+    for (; (mask & 1) == 0; mask >>= 1)
+        ++idx;
+    return idx;
+#endif
+}
@@ -1,41 +1,133 @@
 #include "BigInteger.hpp"
 
 #include <algorithm>
+#include <cctype>
 #include <cmath>
-#include <sstream>
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+
+namespace
+{
+constexpr char DIGITS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
 
-BigInteger::BigInteger(long long number)
+auto digitValue(char c) -> int
 {
-    if (number == 0)
-    {
-        digits_.push_back(0);
-        return;
-    }
+    const auto symbol = static_cast<unsigned char>(c);
+
+    if (std::isdigit(symbol))
+        return c - '0';
+    if (std::isalpha(symbol))
+        return std::tolower(symbol) - 'a' + 10;
+    return std::numeric_limits<int>::max();
+}
+
+// Left to right sliding window exponentiation, base^exponent where bit(i) is bit i of the exponent.
+// Runs of zero bits only square, other bits are taken in windows of up to windowBits bits ending
+// with a one, which multiply by a precomputed odd power of the base.
+template <typename T, typename Bit, typename Multiply>
+auto slidingWindowPower(const T& base, T result, std::size_t bitCnt, Bit bit, Multiply multiply) -> T
+{
+    const std::size_t windowBits = bitCnt > 768 ? 6 : bitCnt > 240 ? 5 : bitCnt > 80 ? 4 : bitCnt > 24 ? 3 : 1;
+    std::vector<T> oddPowers = { base }; // base^1, base^3, base^5 ...
+    const auto square = multiply(base, base);
 
-    if (number < 0)
+    while (oddPowers.size() < std::size_t(1) << (windowBits - 1))
+        oddPowers.push_back(multiply(oddPowers.back(), square));
+
+    for (auto i = bitCnt; i > 0; )
     {
-        sign_ = false;
-        number *= -1;
+        if (!bit(i - 1))
+        {
+            result = multiply(result, result);
+            --i;
+            continue;
+        }
+
+        auto length = std::min(windowBits, i);
+        while (!bit(i - length))
+            --length;
+
+        std::size_t window = 0;
+        for (std::size_t k = 1; k <= length; ++k)
+        {
+            result = multiply(result, result);
+            window = window << 1 | bit(i - k);
+        }
+
+        result = multiply(result, oddPowers[window >> 1]);
+        i -= length;
     }
 
-    while (number > 0)
+    return result;
+}
+
+bool isPowerOfTwo(int base)
+{
+    return (base & (base - 1)) == 0;
+}
+
+auto bitsPerDigit(int base) -> std::size_t
+{
+    std::size_t bits = 0;
+    while (base >>= 1)
+        ++bits;
+    return bits;
+}
+
+} // namespace
+
+BigInteger::BigInteger(long long number) :
+    sign_(number >= 0)
+{
+    // Negated in unsigned arithmetic, the lowest long long has no positive counterpart.
+    auto magnitude = sign_ ? static_cast<unsigned long long>(number) : 0 - static_cast<unsigned long long>(number);
+
+    do
     {
-        digits_.push_back(number % BASE);
-        number /= BASE;
-    }
+        limbs_.push_back(static_cast<Limb>(magnitude));
+        magnitude >>= LIMB_BITS;
+    } while (magnitude > 0);
 }
 
-BigInteger::BigInteger(const std::string& number)
+// Digits of bases that are powers of 2 map directly to bits. Other bases are parsed by parse().
+BigInteger::BigInteger(const std::string& number, int base)
 {
-    int startIdx = number[0] == '-';
+    if (base < 2 || base > 36)
+        throw std::runtime_error("Invalid base");
+
+    std::size_t startIdx = !number.empty() && number[0] == '-';
 
     if (number.empty() || number.begin() + startIdx == number.end() ||
-        std::any_of(number.begin() + startIdx, number.end(), [](char c) { return !std::isdigit(c); }))
+        std::any_of(number.begin() + startIdx, number.end(), [base](char c) { return digitValue(c) >= base; }))
         throw std::runtime_error("Invalid string input");
 
-    for (auto it = number.rbegin(); it != number.rend() - startIdx; ++it)
+    const auto first = number.data() + startIdx;
+    const auto last = number.data() + number.size();
+
+    if (isPowerOfTwo(base))
     {
-        digits_.push_back(*it - '0');
+        const auto bits = bitsPerDigit(base);
+        limbs_.assign((last - first) * bits / LIMB_BITS + 1, 0);
+
+        std::size_t position = 0;
+
+        for (auto it = last; it != first; position += bits)
+        {
+            const Limb value = digitValue(*--it);
+            const auto offset = position % LIMB_BITS;
+
+            limbs_[position / LIMB_BITS] |= value << offset;
+            if (offset + bits > LIMB_BITS)
+                limbs_[position / LIMB_BITS + 1] |= value >> (LIMB_BITS - offset);
+        }
+    }
+    else
+    {
+        *this = parse(first, last, base, radixPowers(base, last - first));
     }
 
     sign_ = startIdx == 0;
@@ -43,25 +135,25 @@ BigInteger::BigInteger(const std::string& number)
 }
 
 BigInteger::BigInteger(const BigInteger& other) :
-    digits_(other.digits_),
+    limbs_(other.limbs_),
     sign_(other.sign_)
 {}
 
 BigInteger::BigInteger(BigInteger&& other) noexcept :
-    digits_(std::move(other.digits_)),
+    limbs_(std::move(other.limbs_)),
     sign_(other.sign_)
 {}
 
 BigInteger& BigInteger::operator=(const BigInteger& other)
 {
-    digits_ = other.digits_;
+    limbs_ = other.limbs_;
     sign_ = other.sign_;
     return *this;
 }
 
 BigInteger& BigInteger::operator=(BigInteger&& other) noexcept
 {
-    digits_ = std::move(other.digits_);
+    limbs_ = std::move(other.limbs_);
     sign_ = other.sign_;
     return *this;
 }
@@ -69,45 +161,64 @@ BigInteger& BigInteger::operator=(BigInteger&& other) noexcept
 void swap(BigInteger& lhs, BigInteger& rhs) noexcept
 {
     using std::swap;
-    swap(lhs.digits_, rhs.digits_);
+    swap(lhs.limbs_, rhs.limbs_);
     swap(lhs.sign_, rhs.sign_);
 }
 
 auto operator<<(std::ostream& os, const BigInteger& bigInteger) -> std::ostream&
 {
-    if (bigInteger.sign_ == false)
-        os << '-';
-
-    for (auto it = bigInteger.digits_.rbegin(); it != bigInteger.digits_.rend(); ++it)
-        os << *it;
-
-    return os;
+    return os << bigInteger.print();
 }
 
 auto BigInteger::print() const -> std::string
 {
-    std::stringstream out;
-    out << *this;
-    return out.str();
+    return toString();
 }
 
-bool BigInteger::compare(long long number) const
+// Digits of bases that are powers of 2 are read directly from the bits. Other bases are
+// formatted by format().
+auto BigInteger::toString(int base) const -> std::string
 {
-    std::size_t digits = number != 0 ? static_cast<std::size_t>(std::floor(std::log10(std::abs(number)))) + 1 : 1;
-    if (sign_ != number >= 0 || digitCnt() != digits)
-        return false;
+    if (base < 2 || base > 36)
+        throw std::runtime_error("Invalid base");
 
-    for (std::size_t i = 0; i < digitCnt(); ++i, number /= BASE)
+    std::string result = sign_ ? "" : "-";
+
+    if (isPowerOfTwo(base))
     {
-        if (digits_[i] != std::abs(number % BASE))
-            return false;
+        const auto bits = bitsPerDigit(base);
+        const auto digitCnt = std::max<std::size_t>((bitCnt() + bits - 1) / bits, 1);
+
+        for (auto position = digitCnt * bits; position > 0; )
+        {
+            position -= bits;
+            const auto offset = position % LIMB_BITS;
+            auto value = limbs_[position / LIMB_BITS] >> offset;
+
+            if (offset + bits > LIMB_BITS && position / LIMB_BITS + 1 < limbs_.size())
+                value |= limbs_[position / LIMB_BITS + 1] << (LIMB_BITS - offset);
+
+            result += DIGITS[value & (base - 1)];
+        }
     }
-    return true;
+    else
+    {
+        const auto digitCnt = static_cast<std::size_t>(bitCnt() * std::log(2.0) / std::log(base)) + 1;
+        const auto powers = radixPowers(base, digitCnt);
+        magnitude().format(base, powers, powers.size() - 1, 0, result);
+    }
+
+    return result;
+}
+
+bool BigInteger::compare(long long number) const
+{
+    return *this == BigInteger(number);
 }
 
 bool operator==(const BigInteger& lhs, const BigInteger& rhs)
 {
-    return lhs.sign_ == rhs.sign_ && lhs.digits_ == rhs.digits_;
+    return lhs.sign_ == rhs.sign_ && lhs.limbs_ == rhs.limbs_;
 }
 
 bool operator!=(const BigInteger& lhs, const BigInteger& rhs)
@@ -120,15 +231,8 @@ bool operator<(const BigInteger& lhs, const BigInteger& rhs)
     if (lhs.sign_ != rhs.sign_)
         return lhs.sign_ < rhs.sign_;
 
-    if (lhs.digitCnt() != rhs.digitCnt())
-        return lhs.sign_ == true ? lhs.digitCnt() < rhs.digitCnt() : lhs.digitCnt() > rhs.digitCnt();
-
-    for (std::size_t i = lhs.digitCnt(); i-- > 0; )
-    {
-        if (lhs.digits_[i] != rhs.digits_[i])
-            return lhs.sign_ == true ? lhs.digits_[i] < rhs.digits_[i] : lhs.digits_[i] > rhs.digits_[i];
-    }
-    return false;
+    const auto comparison = BigInteger::compareMagnitudes(lhs, rhs);
+    return lhs.sign_ == true ? comparison < 0 : comparison > 0;
 }
 
 bool operator>(const BigInteger& lhs, const BigInteger& rhs)
@@ -148,24 +252,7 @@ bool operator>=(const BigInteger& lhs, const BigInteger& rhs)
 
 auto BigInteger::operator++() -> BigInteger&
 {
-    if (this->compare(-1)) // special case -1 -> 0
-    {
-        --digits_[0];
-        changeSign();
-    }
-    else if (sign_ == true)
-    {
-        ++digits_[0];
-        handleCarry();
-    }
-    else
-    {
-        --digits_[0];
-        handleBorrow();
-        removeZeros();
-    }
-
-    return *this;
+    return *this += 1;
 }
 
 auto BigInteger::operator++(int) -> BigInteger
@@ -177,24 +264,7 @@ auto BigInteger::operator++(int) -> BigInteger
 
 auto BigInteger::operator--() -> BigInteger&
 {
-    if (isZero()) // special case 0 -> -1
-    {
-        ++digits_[0];
-        changeSign();
-    }
-    else if (sign_ == true)
-    {
-        --digits_[0];
-        handleBorrow();
-        removeZeros();
-    }
-    else
-    {
-        ++digits_[0];
-        handleCarry();
-    }
-
-    return *this;
+    return *this -= 1;
 }
 
 auto BigInteger::operator--(int) -> BigInteger
@@ -213,29 +283,21 @@ auto BigInteger::operator+(const BigInteger& other) const -> BigInteger
 
 auto BigInteger::operator+=(BigInteger other) -> BigInteger&
 {
-    if (other.isZero())
-        return *this;
-
-    if (sign_ != other.sign_)
+    if (sign_ == other.sign_)
+    {
+        addMagnitude(other);
+    }
+    else if (compareMagnitudes(*this, other) >= 0)
     {
-        other.changeSign();
-        *this -= other;
+        subtractMagnitude(other);
     }
     else
     {
-        if (digitCnt() < other.digitCnt())
-        {
-            digits_.resize(other.digitCnt());
-        }
-
-        for (std::size_t i = 0; i < other.digitCnt(); ++i)
-        {
-            digits_[i] += other.digits_[i];
-        }
-
-        handleCarry();
+        other.subtractMagnitude(*this);
+        swap(*this, other);
     }
 
+    removeZeros();
     return *this;
 }
 
@@ -248,40 +310,8 @@ auto BigInteger::operator-(const BigInteger& other) const -> BigInteger
 
 auto BigInteger::operator-=(BigInteger other) -> BigInteger&
 {
-    if (other.isZero())
-        return *this;
-
-    if (*this == other)
-        return *this = 0;
-
-    if (sign_ != other.sign_)
-    {
-        other.changeSign();
-        *this += other;
-    }
-    else
-    {
-        bool needSignChange = false;
-
-        if (*this < other && sign_ == true || *this > other && sign_ == false)
-        {
-            swap(*this, other);
-            needSignChange = true;
-        }
-
-        for (std::size_t i = 0; i < other.digitCnt(); ++i)
-        {
-            digits_[i] -= other.digits_[i];
-        }
-
-        handleBorrow();
-        removeZeros();
-
-        if (needSignChange)
-            changeSign();
-    }
-
-    return *this;
+    other.changeSign();
+    return *this += other;
 }
 
 auto BigInteger::operator*(const BigInteger& other) const -> BigInteger
@@ -299,19 +329,17 @@ auto BigInteger::operator*=(BigInteger other) -> BigInteger&
     if (other.isZero())
         return *this = 0;
 
+    const auto shorter = std::min(limbs_.size(), other.limbs_.size());
     BigInteger result;
-    result.digits_.resize(digitCnt() + other.digitCnt());
-    result.sign_ = sign_ == other.sign_;
 
-    for (std::size_t i = 0, p = 0; i < other.digitCnt(); ++i, ++p) // long multiplication
-    {
-        for (std::size_t j = 0; j < digitCnt(); ++j)
-        {
-            result.digits_[j + p] += digits_[j] * other.digits_[i]; // counter p adjusts position        
-        }
-    }
+    if (shorter < KARATSUBA_THRESHOLD)
+        result = multiplyLong(*this, other);
+    else if (shorter < TOOM3_THRESHOLD)
+        result = multiplyKaratsuba(*this, other);
+    else
+        result = multiplyToom3(*this, other);
 
-    result.handleCarry();
+    result.sign_ = sign_ == other.sign_;
     result.removeZeros();
     return *this = result;
 }
@@ -325,41 +353,7 @@ auto BigInteger::operator/(const BigInteger& other) const -> BigInteger
 
 auto BigInteger::operator/=(BigInteger other) -> BigInteger&
 {
-    if (other.isZero())
-        throw std::runtime_error("Cannot divide or mod by zero");
-
-    if (this->isZero())
-        return *this;
-
-    bool needSignChange = sign_ != other.sign_;
-    sign_ = true;
-    other.sign_ = true;
-
-    if (*this < other)
-        return *this = 0;
-
-    BigInteger result;
-    BigInteger left;
-
-    for (std::size_t i = digitCnt(); i > 0;) // long division
-    {
-        while (left < other && i > 0)
-        {
-            left = left * BASE + digits_[--i];
-            result *= BASE;
-        }
-
-        while (left >= other) // division by repeated subtraction
-        {
-            left -= other;
-            ++result;
-        }
-    }
-
-    if (needSignChange)
-        result.changeSign();
-
-    return *this = result;
+    return *this = divmod(other).first;
 }
 
 auto BigInteger::operator%(const BigInteger& other) const -> BigInteger
@@ -370,22 +364,21 @@ auto BigInteger::operator%(const BigInteger& other) const -> BigInteger
 }
 
 auto BigInteger::operator%=(BigInteger other) -> BigInteger&
+{
+    return *this = divmod(other).second;
+}
+
+auto BigInteger::divmod(const BigInteger& other) const -> std::pair<BigInteger, BigInteger>
 {
     if (other.isZero())
         throw std::runtime_error("Cannot divide or mod by zero");
 
-    if (*this < other && sign_ == true || *this > other && sign_ == false)
-        return *this;
-
-    if (*this == other)
-        return *this = 0;
-
-    BigInteger result(*this);
-    BigInteger div(*this);
-    div /= other;
-    div *= other;
-    result -= div;
-    return *this = result;
+    auto [quotient, remainder] = divideMagnitudes(*this, other);
+    quotient.sign_ = sign_ == other.sign_;
+    remainder.sign_ = sign_;
+    quotient.removeZeros();
+    remainder.removeZeros();
+    return { quotient, remainder };
 }
 
 auto BigInteger::operator^(const BigInteger& other) const -> BigInteger
@@ -417,7 +410,7 @@ auto BigInteger::operator^=(BigInteger other) -> BigInteger&
         if (other.isEven())
         {
             base *= base;
-            other /= 2;
+            other.divideSmall(2);
         }
         else
         {
@@ -429,89 +422,918 @@ auto BigInteger::operator^=(BigInteger other) -> BigInteger&
     return *this = result;
 }
 
+// Arithmetic modulo an odd modulus in Montgomery form: x is kept as x R mod m with R = 2^(32 n)
+// for a modulus of n limbs. The product of two such numbers is reduced by adding multiples of m
+// that clear the low limbs and dropping them, which needs no division.
+class BigInteger::Montgomery
+{
+public:
+    using Number = std::vector<Limb>;
+
+    explicit Montgomery(const BigInteger& modulus);
+
+    auto toMontgomery(const BigInteger& number) const -> Number;
+    auto fromMontgomery(const Number& number) const -> BigInteger;
+    auto multiply(const Number& lhs, const Number& rhs) const -> Number;
+
+private:
+    BigInteger modulus_;
+    std::size_t size_;
+    Limb inverse_; // -1 / m mod 2^32
+};
+
+BigInteger::Montgomery::Montgomery(const BigInteger& modulus) :
+    modulus_(modulus),
+    size_(modulus.limbs_.size())
+{
+    // Newton's iteration, each step doubles the correct low bits (3 to begin with for odd m).
+    Limb inverse = modulus.limbs_[0];
+    for (int i = 0; i < 4; ++i)
+        inverse *= 2 - modulus.limbs_[0] * inverse;
+
+    inverse_ = 0 - inverse;
+}
+
+// number in [0, m) to number R mod m.
+auto BigInteger::Montgomery::toMontgomery(const BigInteger& number) const -> Number
+{
+    auto shifted = number;
+    shifted.shiftLimbs(size_);
+    auto result = (shifted % modulus_).limbs_;
+    result.resize(size_);
+    return result;
+}
+
+auto BigInteger::Montgomery::fromMontgomery(const Number& number) const -> BigInteger
+{
+    Number one(size_);
+    one[0] = 1;
+
+    BigInteger result;
+    result.limbs_ = multiply(number, one);
+    result.removeZeros();
+    return result;
+}
+
+// lhs rhs / R mod m by coarsely integrated operand scanning: every limb of rhs adds its product
+// with lhs, then a multiple of m clears the lowest limb, which is shifted out.
+auto BigInteger::Montgomery::multiply(const Number& lhs, const Number& rhs) const -> Number
+{
+    const auto& m = modulus_.limbs_;
+    Number t(size_ + 2);
+
+    for (std::size_t i = 0; i < size_; ++i)
+    {
+        const DoubleLimb factor = rhs[i];
+        DoubleLimb carry = 0;
+
+        for (std::size_t j = 0; j < size_; ++j)
+        {
+            carry += t[j] + factor * lhs[j];
+            t[j] = static_cast<Limb>(carry);
+            carry >>= LIMB_BITS;
+        }
+
+        carry += t[size_];
+        t[size_] = static_cast<Limb>(carry);
+        t[size_ + 1] = static_cast<Limb>(carry >> LIMB_BITS);
+
+        const DoubleLimb reducer = static_cast<Limb>(t[0] * inverse_);
+        carry = (t[0] + reducer * m[0]) >> LIMB_BITS;
+
+        for (std::size_t j = 1; j < size_; ++j)
+        {
+            carry += t[j] + reducer * m[j];
+            t[j - 1] = static_cast<Limb>(carry);
+            carry >>= LIMB_BITS;
+        }
+
+        carry += t[size_];
+        t[size_ - 1] = static_cast<Limb>(carry);
+        t[size_] = static_cast<Limb>(t[size_ + 1] + (carry >> LIMB_BITS));
+    }
+
+    // The result is below 2m, at most one subtraction brings it to [0, m).
+    const bool reduce = t[size_] != 0 || !std::lexicographical_compare(t.rend() - size_, t.rend(), m.rbegin(), m.rend());
+
+    if (reduce)
+    {
+        DoubleLimb borrow = 0;
+        for (std::size_t i = 0; i < size_; ++i)
+        {
+            const auto subtrahend = m[i] + borrow;
+            borrow = t[i] < subtrahend;
+            t[i] = static_cast<Limb>(t[i] - subtrahend);
+        }
+    }
+
+    t.resize(size_);
+    return t;
+}
+
+// Odd moduli use Montgomery multiplication, even ones reduce every product by division. A
+// negative exponent raises the inverse of base.
+auto BigInteger::powMod(const BigInteger& base, const BigInteger& exponent, const BigInteger& modulus) -> BigInteger
+{
+    if (modulus.isZero())
+        throw std::runtime_error("Cannot divide or mod by zero");
+
+    if (modulus.sign_ == false)
+        throw std::runtime_error("Invalid modulus");
+
+    auto reduced = base % modulus;
+    if (reduced.sign_ == false)
+        reduced += modulus;
+
+    if (exponent.sign_ == false)
+        return powMod(modInverse(reduced, modulus), exponent.magnitude(), modulus);
+
+    if (modulus == 1)
+        return 0;
+
+    if (exponent.isZero())
+        return 1;
+
+    const auto bit = [&exponent](std::size_t i) { return (exponent.limbs_[i / LIMB_BITS] >> i % LIMB_BITS & 1) != 0; };
+
+    if (modulus.isEven())
+    {
+        return slidingWindowPower(reduced, BigInteger(1), exponent.bitCnt(), bit,
+                                  [&modulus](const BigInteger& lhs, const BigInteger& rhs) { return lhs * rhs % modulus; });
+    }
+
+    const Montgomery montgomery(modulus);
+    const auto result = slidingWindowPower(montgomery.toMontgomery(reduced), montgomery.toMontgomery(1), exponent.bitCnt(), bit,
+                                           [&montgomery](const Montgomery::Number& lhs, const Montgomery::Number& rhs) {
+                                               return montgomery.multiply(lhs, rhs);
+                                           });
+    return montgomery.fromMontgomery(result);
+}
+
+// Euclid's algorithm, the result is non-negative.
+auto BigInteger::gcd(const BigInteger& lhs, const BigInteger& rhs) -> BigInteger
+{
+    auto a = lhs.magnitude();
+    auto b = rhs.magnitude();
+
+    while (!b.isZero())
+    {
+        a %= b;
+        swap(a, b);
+    }
+
+    return a;
+}
+
+// Extended Euclid's algorithm, only the coefficient of number is tracked. The result is in [0, modulus).
+auto BigInteger::modInverse(const BigInteger& number, const BigInteger& modulus) -> BigInteger
+{
+    if (modulus.isZero() || modulus.sign_ == false)
+        throw std::runtime_error("Invalid modulus");
+
+    auto previous = modulus;
+    auto current = number % modulus;
+    if (current.sign_ == false)
+        current += modulus;
+
+    BigInteger previousCoefficient = 0;
+    BigInteger currentCoefficient = 1;
+
+    while (!current.isZero())
+    {
+        auto [quotient, remainder] = previous.divmod(current);
+        previous = std::move(current);
+        current = std::move(remainder);
+
+        auto coefficient = previousCoefficient - quotient * currentCoefficient;
+        previousCoefficient = std::move(currentCoefficient);
+        currentCoefficient = std::move(coefficient);
+    }
+
+    if (previous != 1)
+        throw std::runtime_error("No modular inverse");
+
+    if (previousCoefficient.sign_ == false)
+        previousCoefficient += modulus;
+
+    return previousCoefficient % modulus;
+}
+
+// Trial division by small primes, then Miller-Rabin: with n - 1 = d 2^s, a prime n gives for every
+// base a either a^d = 1 or a^(d 2^r) = -1 for some r < s. Below 3.3e24 the prime bases up to 41
+// decide primality exactly. Larger numbers are tested with bases drawn uniformly from [2, n - 2]
+// by a generator seeded from std::random_device: fixed bases can be defeated by constructed
+// composites, while a composite passes a random base with probability at most 1/4.
+bool BigInteger::isProbablePrime(std::size_t rounds) const
+{
+    static constexpr int SMALL_PRIMES[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67, 71 };
+    static constexpr std::size_t DETERMINISTIC_BASES = 13; // the primes up to 41
+    static const BigInteger DETERMINISTIC_LIMIT("3317044064679887385961981");
+
+    if (*this < 2)
+        return false;
+
+    for (auto prime : SMALL_PRIMES)
+    {
+        if (*this == prime)
+            return true;
+
+        if (magnitude().divideSmall(prime) == 0)
+            return false;
+    }
+
+    const auto previous = *this - 1;
+    auto odd = previous;
+    std::size_t twos = 0;
+
+    while (odd.isEven())
+    {
+        odd.shiftRight(1);
+        ++twos;
+    }
+
+    const Montgomery montgomery(*this);
+    const auto one = montgomery.toMontgomery(1);
+    const auto minusOne = montgomery.toMontgomery(previous);
+
+    const auto isWitness = [&](const BigInteger& base) {
+        auto x = montgomery.toMontgomery(powMod(base, odd, *this));
+        if (x == one || x == minusOne)
+            return false;
+
+        for (std::size_t r = 1; r < twos; ++r)
+        {
+            x = montgomery.multiply(x, x);
+            if (x == minusOne)
+                return false;
+        }
+
+        return true;
+    };
+
+    if (*this < DETERMINISTIC_LIMIT)
+    {
+        return std::none_of(SMALL_PRIMES, SMALL_PRIMES + DETERMINISTIC_BASES,
+                            [&](int prime) { return isWitness(BigInteger(prime)); });
+    }
+
+    std::random_device device;
+    std::seed_seq seed = { device(), device(), device(), device(), device(), device(), device(), device() };
+    std::mt19937_64 random(seed);
+
+    // Uniform in [0, n - 3) by rejection: a random number of the bit length of n - 3 is below it
+    // with probability over 1/2.
+    const auto range = *this - 3;
+    const auto bits = range.bitCnt();
+    BigInteger offset;
+
+    for (std::size_t round = 0; round < rounds; ++round)
+    {
+        do
+        {
+            offset.limbs_.resize((bits + LIMB_BITS - 1) / LIMB_BITS);
+            for (auto& limb : offset.limbs_)
+                limb = static_cast<Limb>(random());
+
+            if (bits % LIMB_BITS != 0)
+                offset.limbs_.back() &= (Limb(1) << bits % LIMB_BITS) - 1;
+
+            offset.removeZeros();
+        } while (compareMagnitudes(offset, range) >= 0);
+
+        if (isWitness(offset + 2))
+            return false;
+    }
+
+    return true;
+}
+
+// The digit based functions work on the decimal representation.
 auto BigInteger::digitCnt() const -> std::size_t
 {
-    return digits_.size();
+    return print().size() - !sign_;
 }
 
 auto BigInteger::digitSum() const -> std::size_t
 {
     std::size_t sum = 0;
-    for (auto d : digits_)
-        sum += d;
+    for (auto c : print())
+        sum += c != '-' ? c - '0' : 0;
     return sum;
 }
 
 bool BigInteger::isZero() const
 {
-    return digits_[0] == 0 && digitCnt() == 1;
+    return limbs_[0] == 0 && limbs_.size() == 1;
 }
 
 bool BigInteger::isEven() const
 {
-    return digits_[0] % 2 == 0;
+    return limbs_[0] % 2 == 0;
 }
 
 auto BigInteger::reverse() const -> BigInteger
 {
-    BigInteger result(*this);
-    std::reverse(result.digits_.begin(), result.digits_.end());
+    auto digits = print().substr(!sign_);
+    std::reverse(digits.begin(), digits.end());
+
+    BigInteger result(digits);
+    result.sign_ = sign_;
     result.removeZeros();
     return result;
 }
 
 bool BigInteger::isPalindrome() const
 {
-    for (std::size_t i = 0, j = digitCnt() - 1; i < j; ++i, --j)
+    const auto digits = print().substr(!sign_);
+    return std::equal(digits.begin(), digits.begin() + digits.size() / 2, digits.rbegin());
+}
+
+// Returns a negative number, zero or a positive number as |lhs| is less, equal or greater than |rhs|.
+int BigInteger::compareMagnitudes(const BigInteger& lhs, const BigInteger& rhs)
+{
+    if (lhs.limbs_.size() != rhs.limbs_.size())
+        return lhs.limbs_.size() < rhs.limbs_.size() ? -1 : 1;
+
+    for (std::size_t i = lhs.limbs_.size(); i-- > 0; )
     {
-        if (digits_[i] != digits_[j])
-            return false;
+        if (lhs.limbs_[i] != rhs.limbs_[i])
+            return lhs.limbs_[i] < rhs.limbs_[i] ? -1 : 1;
     }
-    return true;
+    return 0;
 }
 
-void BigInteger::changeSign()
+// |this| += |other|, the carry is the upper half of the double limb sum.
+void BigInteger::addMagnitude(const BigInteger& other)
 {
-    sign_ = !sign_;
+    if (limbs_.size() < other.limbs_.size())
+        limbs_.resize(other.limbs_.size());
+
+    DoubleLimb carry = 0;
+
+    for (std::size_t i = 0; i < limbs_.size() && (i < other.limbs_.size() || carry != 0); ++i)
+    {
+        carry += static_cast<DoubleLimb>(limbs_[i]) + (i < other.limbs_.size() ? other.limbs_[i] : 0);
+        limbs_[i] = static_cast<Limb>(carry);
+        carry >>= LIMB_BITS;
+    }
+
+    if (carry != 0)
+        limbs_.push_back(static_cast<Limb>(carry));
 }
 
-// If the digit is greater or equal to base, adjust it and increase the next digit.
-void BigInteger::handleCarry()
+// |this| -= |other|, requires |this| >= |other|. Leading zero limbs are left to the caller.
+void BigInteger::subtractMagnitude(const BigInteger& other)
 {
-    for (std::size_t i = 0; i < digitCnt(); ++i)
+    DoubleLimb borrow = 0;
+
+    for (std::size_t i = 0; i < limbs_.size() && (i < other.limbs_.size() || borrow != 0); ++i)
     {
-        if (digits_[i] < BASE)
-            continue;
+        const auto subtrahend = (i < other.limbs_.size() ? other.limbs_[i] : 0) + borrow;
+        borrow = limbs_[i] < subtrahend;
+        limbs_[i] = static_cast<Limb>(limbs_[i] - subtrahend);
+    }
+}
+
+// |this| = |this| * factor + addend.
+void BigInteger::multiplySmall(Limb factor, Limb addend)
+{
+    DoubleLimb carry = addend;
+
+    for (auto& limb : limbs_)
+    {
+        carry += static_cast<DoubleLimb>(limb) * factor;
+        limb = static_cast<Limb>(carry);
+        carry >>= LIMB_BITS;
+    }
 
-        if (i == digitCnt() - 1)
+    if (carry != 0)
+        limbs_.push_back(static_cast<Limb>(carry));
+}
+
+// |this| /= divisor by short division, returns the remainder.
+auto BigInteger::divideSmall(Limb divisor) -> Limb
+{
+    DoubleLimb remainder = 0;
+
+    for (std::size_t i = limbs_.size(); i-- > 0; )
+    {
+        const auto current = remainder << LIMB_BITS | limbs_[i];
+        limbs_[i] = static_cast<Limb>(current / divisor);
+        remainder = current % divisor;
+    }
+
+    removeZeros();
+    return static_cast<Limb>(remainder);
+}
+
+// Most digits of the base that fit in a limb, and the base raised to them.
+auto BigInteger::radixChunk(int base) -> std::pair<std::size_t, Limb>
+{
+    std::size_t digits = 0;
+    DoubleLimb power = 1;
+
+    while (power * base <= std::numeric_limits<Limb>::max())
+    {
+        power *= base;
+        ++digits;
+    }
+
+    return { digits, static_cast<Limb>(power) };
+}
+
+// Powers of the base with chunk digits, chunk 2 chunks, 4 chunks ..., each the square of the previous
+// one, until the square of the last one has at least digitCnt digits.
+auto BigInteger::radixPowers(int base, std::size_t digitCnt) -> std::vector<BigInteger>
+{
+    const auto [chunkDigits, chunk] = radixChunk(base);
+    std::vector<BigInteger> powers = { BigInteger(chunk) };
+
+    while (chunkDigits << powers.size() < digitCnt)
+        powers.push_back(powers.back() * powers.back());
+
+    return powers;
+}
+
+// Short strings are read chunk by chunk, each multiplying the number read so far by a power of
+// the base. Longer ones are split so that the lower part has chunk 2^i digits, the largest such
+// count below the length, and are combined as high * powers[i] + low.
+auto BigInteger::parse(const char* first, const char* last, int base, const std::vector<BigInteger>& powers) -> BigInteger
+{
+    const auto [chunkDigits, chunk] = radixChunk(base);
+    const auto length = static_cast<std::size_t>(last - first);
+
+    if (length <= chunkDigits * CONVERSION_THRESHOLD)
+    {
+        BigInteger result;
+        auto chunkSize = (length - 1) % chunkDigits + 1;
+
+        for (; first != last; first += chunkSize, chunkSize = chunkDigits)
         {
-            digits_.push_back(0);
+            Limb value = 0;
+            Limb scale = 1;
+
+            for (auto it = first; it != first + chunkSize; ++it)
+            {
+                value = value * base + digitValue(*it);
+                scale *= base;
+            }
+
+            result.multiplySmall(scale, value);
         }
 
-        digits_[i + 1] += digits_[i] / BASE;
-        digits_[i] %= BASE;
+        return result;
     }
+
+    std::size_t level = 0;
+    while (chunkDigits << (level + 1) < length)
+        ++level;
+
+    const auto split = last - (chunkDigits << level);
+    auto result = parse(first, split, base, powers) * powers[level];
+    return result += parse(split, last, base, powers);
 }
 
-// If the digit is negative, adjust it and decrease the next digit.
-void BigInteger::handleBorrow()
+// Appends the digits of the absolute value, padded with zeros to width. Small numbers are
+// converted chunk by chunk as remainders of short division. Larger ones, less than
+// powers[level]^2, are split by dividing by powers[level] and the lower part is padded to its
+// full length.
+void BigInteger::format(int base, const std::vector<BigInteger>& powers, std::size_t level, std::size_t width,
+                        std::string& out) const
 {
-    for (std::size_t i = 0; i < digitCnt(); ++i)
+    while (level > 0 && compareMagnitudes(*this, powers[level]) < 0)
+        --level;
+
+    const auto [chunkDigits, chunk] = radixChunk(base);
+
+    if (limbs_.size() > CONVERSION_THRESHOLD && level > 0)
     {
-        if (digits_[i] >= 0)
-            continue;
+        const auto [high, low] = divmod(powers[level]);
+        const auto lowWidth = chunkDigits << level;
+
+        high.format(base, powers, level - 1, width > lowWidth ? width - lowWidth : 0, out);
+        low.format(base, powers, level - 1, lowWidth, out);
+        return;
+    }
+
+    auto rest = magnitude();
+    std::string digits;
+
+    do
+    {
+        auto value = rest.divideSmall(chunk);
+
+        for (std::size_t i = 0; i < chunkDigits && (value != 0 || !rest.isZero()); ++i, value /= base)
+            digits += DIGITS[value % base];
+    } while (!rest.isZero());
+
+    if (digits.empty())
+        digits = "0";
+
+    digits.append(width > digits.size() ? width - digits.size() : 0, '0');
+    out.append(digits.rbegin(), digits.rend());
+}
+
+auto BigInteger::magnitude() const -> BigInteger
+{
+    BigInteger result(*this);
+    result.sign_ = true;
+    return result;
+}
+
+// Number of significant bits of the absolute value.
+auto BigInteger::bitCnt() const -> std::size_t
+{
+    std::size_t bits = (limbs_.size() - 1) * LIMB_BITS;
+    for (auto top = limbs_.back(); top != 0; top >>= 1)
+        ++bits;
+    return bits;
+}
+
+// |this| *= 2^bits.
+void BigInteger::shiftLeft(std::size_t bits)
+{
+    const auto offset = bits % LIMB_BITS;
+
+    if (offset != 0)
+    {
+        Limb carry = 0;
+
+        for (auto& limb : limbs_)
+        {
+            const Limb next = limb >> (LIMB_BITS - offset);
+            limb = limb << offset | carry;
+            carry = next;
+        }
+
+        if (carry != 0)
+            limbs_.push_back(carry);
+    }
 
-        --digits_[i + 1];
-        digits_[i] += BASE;
+    shiftLimbs(bits / LIMB_BITS);
+}
+
+// |this| /= 2^bits, rounded down.
+void BigInteger::shiftRight(std::size_t bits)
+{
+    const auto offset = bits % LIMB_BITS;
+
+    if (bits / LIMB_BITS >= limbs_.size())
+    {
+        limbs_.assign(1, 0);
+        sign_ = true;
+        return;
+    }
+
+    limbs_.erase(limbs_.begin(), limbs_.begin() + bits / LIMB_BITS);
+
+    if (offset != 0)
+    {
+        for (std::size_t i = 0; i < limbs_.size(); ++i)
+        {
+            const Limb next = i + 1 < limbs_.size() ? limbs_[i + 1] << (LIMB_BITS - offset) : 0;
+            limbs_[i] = limbs_[i] >> offset | next;
+        }
+    }
+
+    removeZeros();
+}
+
+// Division functions return the quotient and remainder of absolute values, the caller sets the signs.
+auto BigInteger::divideMagnitudes(const BigInteger& lhs, const BigInteger& rhs) -> std::pair<BigInteger, BigInteger>
+{
+    if (compareMagnitudes(lhs, rhs) < 0)
+        return { 0, lhs.magnitude() };
+
+    if (rhs.limbs_.size() == 1)
+    {
+        auto quotient = lhs.magnitude();
+        const auto remainder = quotient.divideSmall(rhs.limbs_[0]);
+        return { quotient, remainder };
+    }
+
+    if (rhs.limbs_.size() >= BURNIKEL_ZIEGLER_THRESHOLD &&
+        lhs.limbs_.size() - rhs.limbs_.size() >= BURNIKEL_ZIEGLER_THRESHOLD)
+        return divideBurnikelZiegler(lhs, rhs);
+
+    return divideKnuth(lhs, rhs);
+}
+
+// Knuth's Algorithm D (TAOCP 4.3.1) for divisors of at least two limbs, |lhs| >= |rhs|. Both are
+// shifted so that the top bit of the divisor is set, then each quotient limb is estimated from
+// the top two limbs of the remainder and the top limb of the divisor, corrected with the second
+// limb of the divisor. The estimate is then at most one too large, which the final add back fixes.
+auto BigInteger::divideKnuth(const BigInteger& lhs, const BigInteger& rhs) -> std::pair<BigInteger, BigInteger>
+{
+    const auto shift = LIMB_BITS * rhs.limbs_.size() - rhs.bitCnt();
+    auto remainder = lhs.magnitude();
+    auto divisor = rhs.magnitude();
+    remainder.shiftLeft(shift);
+    divisor.shiftLeft(shift);
+    remainder.limbs_.push_back(0);
+
+    auto& u = remainder.limbs_;
+    const auto& v = divisor.limbs_;
+    const auto n = v.size();
+    const auto m = u.size() - n - 1;
+
+    BigInteger quotient;
+    quotient.limbs_.resize(m + 1);
+
+    for (auto j = m + 1; j-- > 0; )
+    {
+        const auto top = static_cast<DoubleLimb>(u[j + n]) << LIMB_BITS | u[j + n - 1];
+        auto estimate = top / v[n - 1];
+        auto estimateRemainder = top % v[n - 1];
+
+        while (estimate >> LIMB_BITS != 0 ||
+               estimate * v[n - 2] > (estimateRemainder << LIMB_BITS | u[j + n - 2]))
+        {
+            --estimate;
+            estimateRemainder += v[n - 1];
+            if (estimateRemainder >> LIMB_BITS != 0)
+                break;
+        }
+
+        DoubleLimb carry = 0;
+        DoubleLimb borrow = 0;
+
+        for (std::size_t i = 0; i < n; ++i) // subtract estimate * divisor
+        {
+            const auto product = estimate * v[i] + carry;
+            carry = product >> LIMB_BITS;
+            const auto subtrahend = static_cast<Limb>(product) + borrow;
+            borrow = u[i + j] < subtrahend;
+            u[i + j] = static_cast<Limb>(u[i + j] - subtrahend);
+        }
+
+        const auto subtrahend = carry + borrow;
+        const bool negative = u[j + n] < subtrahend;
+        u[j + n] = static_cast<Limb>(u[j + n] - subtrahend);
+
+        if (negative) // estimate was one too large, add the divisor back
+        {
+            --estimate;
+            carry = 0;
+
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                carry += static_cast<DoubleLimb>(u[i + j]) + v[i];
+                u[i + j] = static_cast<Limb>(carry);
+                carry >>= LIMB_BITS;
+            }
+
+            u[j + n] = static_cast<Limb>(u[j + n] + carry);
+        }
+
+        quotient.limbs_[j] = static_cast<Limb>(estimate);
     }
+
+    quotient.removeZeros();
+    remainder.removeZeros();
+    remainder.shiftRight(shift);
+    return { quotient, remainder };
+}
+
+// Recursive division by Burnikel and Ziegler, which splits a division into smaller ones and
+// multiplications, so it is as fast as the multiplication. The divisor is shifted to fill exactly
+// n = j 2^k limbs (j below the threshold) with its top bit set. The dividend is cut into blocks of
+// n limbs and divided from the top, two blocks at a time.
+auto BigInteger::divideBurnikelZiegler(const BigInteger& lhs, const BigInteger& rhs) -> std::pair<BigInteger, BigInteger>
+{
+    std::size_t levels = 0;
+    while (rhs.limbs_.size() >> levels >= BURNIKEL_ZIEGLER_THRESHOLD)
+        ++levels;
+
+    const auto n = (((rhs.limbs_.size() - 1) >> levels) + 1) << levels;
+    const auto shift = n * LIMB_BITS - rhs.bitCnt();
+    auto dividend = lhs.magnitude();
+    auto divisor = rhs.magnitude();
+    dividend.shiftLeft(shift);
+    divisor.shiftLeft(shift);
+
+    // The top block must have its top bit clear, so it is less than the divisor.
+    const auto blockCnt = std::max<std::size_t>(2, dividend.bitCnt() / (n * LIMB_BITS) + 1);
+
+    BigInteger quotient;
+    auto current = dividend.slice((blockCnt - 2) * n, 2 * n);
+
+    for (auto i = blockCnt - 1; i-- > 0; )
+    {
+        auto [partQuotient, remainder] = divide2n1n(current, divisor, n);
+        partQuotient.shiftLimbs(i * n);
+        quotient += partQuotient;
+
+        if (i == 0)
+        {
+            remainder.shiftRight(shift);
+            return { quotient, remainder };
+        }
+
+        remainder.shiftLimbs(n);
+        current = remainder + dividend.slice((i - 1) * n, n);
+    }
+
+    return { quotient, 0 };
+}
+
+// Divides lhs < rhs 2^(32 n) by rhs of n limbs with the top bit set, as two divisions of 3 halves
+// by 2 halves.
+auto BigInteger::divide2n1n(const BigInteger& lhs, const BigInteger& rhs, std::size_t n) -> std::pair<BigInteger, BigInteger>
+{
+    if (n % 2 != 0 || n < BURNIKEL_ZIEGLER_THRESHOLD)
+        return divideMagnitudes(lhs, rhs);
+
+    const auto half = n / 2;
+    auto [high, remainder] = divide3n2n(lhs.slice(half, 3 * half), rhs, half);
+    remainder.shiftLimbs(half);
+    remainder += lhs.slice(0, half);
+
+    auto [low, result] = divide3n2n(remainder, rhs, half);
+    high.shiftLimbs(half);
+    high += low;
+    return { high, result };
+}
+
+// Divides lhs = [a1 a2 a3] < rhs 2^(32 half) by rhs = [b1 b2] (halves of half limbs). The quotient
+// is estimated by dividing [a1 a2] by b1, which is at most 2 too large.
+auto BigInteger::divide3n2n(const BigInteger& lhs, const BigInteger& rhs, std::size_t half) -> std::pair<BigInteger, BigInteger>
+{
+    const auto top = lhs.slice(2 * half, half);
+    const auto topTwo = lhs.slice(half, 2 * half);
+    const auto rhsHigh = rhs.slice(half, half);
+    BigInteger quotient;
+    BigInteger remainder;
+
+    if (compareMagnitudes(top, rhsHigh) < 0)
+    {
+        std::tie(quotient, remainder) = divide2n1n(topTwo, rhsHigh, half);
+    }
+    else // quotient 2^(32 half) - 1
+    {
+        quotient.limbs_.assign(half, ~Limb(0));
+        auto shifted = rhsHigh;
+        shifted.shiftLimbs(half);
+        remainder = topTwo - shifted + rhsHigh;
+    }
+
+    remainder.shiftLimbs(half);
+    remainder += lhs.slice(0, half);
+    remainder -= quotient * rhs.slice(0, half);
+
+    while (remainder.sign_ == false)
+    {
+        --quotient;
+        remainder += rhs;
+    }
+
+    return { quotient, remainder };
+}
+
+// Multiplication functions return the product of absolute values, the caller sets the sign.
+auto BigInteger::multiplyLong(const BigInteger& lhs, const BigInteger& rhs) -> BigInteger
+{
+    BigInteger result;
+    result.limbs_.resize(lhs.limbs_.size() + rhs.limbs_.size());
+
+    for (std::size_t i = 0; i < rhs.limbs_.size(); ++i) // long multiplication
+    {
+        const DoubleLimb factor = rhs.limbs_[i];
+        DoubleLimb carry = 0;
+
+        for (std::size_t j = 0; j < lhs.limbs_.size(); ++j)
+        {
+            carry += result.limbs_[i + j] + factor * lhs.limbs_[j]; // fits, (2^32 - 1)^2 + 2 (2^32 - 1) = 2^64 - 1
+            result.limbs_[i + j] = static_cast<Limb>(carry);
+            carry >>= LIMB_BITS;
+        }
+
+        result.limbs_[i + lhs.limbs_.size()] = static_cast<Limb>(carry);
+    }
+
+    result.removeZeros();
+    return result;
+}
+
+// With x = 2^(32 half), (a1 x + a0)(b1 x + b0) = a1 b1 x^2 + ((a1 + a0)(b1 + b0) - a1 b1 - a0 b0) x + a0 b0
+// needs three half-size products instead of four. If one operand does not reach past half, the
+// longer one is multiplied in two halves instead.
+auto BigInteger::multiplyKaratsuba(const BigInteger& lhs, const BigInteger& rhs) -> BigInteger
+{
+    const auto half = std::max(lhs.limbs_.size(), rhs.limbs_.size()) / 2;
+    const auto& longer = lhs.limbs_.size() >= rhs.limbs_.size() ? lhs : rhs;
+    const auto& shorter = lhs.limbs_.size() >= rhs.limbs_.size() ? rhs : lhs;
+    auto low = longer.slice(0, half);
+    auto high = longer.slice(half, longer.limbs_.size() - half);
+    auto other = shorter.slice(0, shorter.limbs_.size());
+
+    if (other.limbs_.size() <= half)
+    {
+        auto result = high * other;
+        result.shiftLimbs(half);
+        return result += low * other;
+    }
+
+    auto otherLow = other.slice(0, half);
+    auto otherHigh = other.slice(half, other.limbs_.size() - half);
+    auto lowProduct = low * otherLow;
+    auto highProduct = high * otherHigh;
+    auto middle = (low + high) * (otherLow + otherHigh) - lowProduct - highProduct;
+
+    highProduct.shiftLimbs(2 * half);
+    middle.shiftLimbs(half);
+    highProduct += middle;
+    return highProduct += lowProduct;
+}
+
+// Operands are split into three parts, a2 x^2 + a1 x + a0 with x = 2^(32 part), and the product of
+// degree 4 is evaluated at 0, 1, -1, -2 and infinity by five products of a third of the size. The
+// coefficients are then interpolated (sequence by Bodrato) with exact divisions by 2 and 3 only.
+// Unbalanced operands go to Karatsuba, which splits the longer one.
+auto BigInteger::multiplyToom3(const BigInteger& lhs, const BigInteger& rhs) -> BigInteger
+{
+    const auto longer = std::max(lhs.limbs_.size(), rhs.limbs_.size());
+    const auto part = (longer + 2) / 3;
+
+    if (std::min(lhs.limbs_.size(), rhs.limbs_.size()) <= 2 * part)
+        return multiplyKaratsuba(lhs, rhs);
+
+    struct Evaluation
+    {
+        BigInteger atZero, atOne, atMinusOne, atMinusTwo, atInfinity;
+    };
+
+    const auto evaluate = [part](const BigInteger& number) {
+        const auto a0 = number.slice(0, part);
+        const auto a1 = number.slice(part, part);
+        const auto a2 = number.slice(2 * part, number.limbs_.size() - 2 * part);
+        const auto sum = a0 + a2;
+        const auto atMinusOne = sum - a1;
+        return Evaluation{ a0, sum + a1, atMinusOne, (atMinusOne + a2) * 2 - a0, a2 };
+    };
+
+    const auto x = evaluate(lhs);
+    const auto y = evaluate(rhs);
+
+    auto r0 = x.atZero * y.atZero;
+    auto r1 = x.atOne * y.atOne;
+    auto r2 = x.atMinusOne * y.atMinusOne;
+    auto r3 = x.atMinusTwo * y.atMinusTwo;
+    auto r4 = x.atInfinity * y.atInfinity;
+
+    r3 -= r1;
+    r3.divideSmall(3);
+    r1 -= r2;
+    r1.divideSmall(2);
+    r2 -= r0;
+    r3 = r2 - r3;
+    r3.divideSmall(2);
+    r3 += r4 * 2;
+    r2 += r1;
+    r2 -= r4;
+    r1 -= r3;
+
+    r4.shiftLimbs(4 * part);
+    r3.shiftLimbs(3 * part);
+    r2.shiftLimbs(2 * part);
+    r1.shiftLimbs(part);
+    r4 += r3;
+    r4 += r2;
+    r4 += r1;
+    return r4 += r0;
+}
+
+// Non-negative number made of count limbs starting at first (fewer if the number is shorter).
+auto BigInteger::slice(std::size_t first, std::size_t count) const -> BigInteger
+{
+    BigInteger result;
+    if (first >= limbs_.size())
+        return result;
+
+    const auto last = std::min(first + count, limbs_.size());
+    result.limbs_.assign(limbs_.begin() + first, limbs_.begin() + last);
+    result.removeZeros();
+    return result;
+}
+
+// Multiply by 2^(32 count).
+void BigInteger::shiftLimbs(std::size_t count)
+{
+    if (!isZero())
+        limbs_.insert(limbs_.begin(), count, 0);
+}
+
+void BigInteger::changeSign()
+{
+    sign_ = !sign_;
 }
 
-// Remove starting zeros i.e. 003 -> 3 (this can happen in substraction and multiplication).
+// Remove leading zero limbs (this can happen in subtraction and division).
 void BigInteger::removeZeros()
 {
-    while (digits_.back() == 0 && digitCnt() > 1)
+    while (limbs_.back() == 0 && limbs_.size() > 1)
     {
-        digits_.pop_back();
+        limbs_.pop_back();
     }
 
     if (isZero())
@@ -1,16 +1,20 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
 // BigInteger represents a large whole number and supports basic arithmetic operations.
 // This is useful in calculations where larger numbers than the standard types are required.
+// The number is stored in binary, as 32 bit limbs, and converted to decimal (or any base up to 36)
+// only when it is constructed from or printed to a string.
 class BigInteger
 {
 public:
     BigInteger() : BigInteger(0) {}
     BigInteger(long long number);
-    BigInteger(const std::string& number);
+    BigInteger(const std::string& number, int base = 10);
     BigInteger(const BigInteger& other);
     BigInteger(BigInteger&& other) noexcept;
     BigInteger& operator=(const BigInteger& other);
@@ -20,6 +24,7 @@ public:
     friend void swap(BigInteger& lhs, BigInteger& rhs) noexcept;
     friend auto operator<<(std::ostream& os, const BigInteger& bigInteger) -> std::ostream&;
     auto print() const -> std::string;
+    auto toString(int base = 10) const -> std::string;
     bool compare(long long number) const;
 
     friend bool operator==(const BigInteger& lhs, const BigInteger& rhs);
@@ -48,6 +53,9 @@ public:
     auto operator%=(BigInteger other) -> BigInteger&;
     auto operator^=(BigInteger other) -> BigInteger&;
 
+    // Quotient rounded towards zero and remainder with the sign of this number, like / and %.
+    auto divmod(const BigInteger& other) const -> std::pair<BigInteger, BigInteger>;
+
     auto digitCnt() const -> std::size_t;
     auto digitSum() const -> std::size_t;
     bool isZero() const;
@@ -55,14 +63,59 @@ public:
     auto reverse() const -> BigInteger;
     bool isPalindrome() const;
 
+    static auto powMod(const BigInteger& base, const BigInteger& exponent, const BigInteger& modulus) -> BigInteger;
+    static auto gcd(const BigInteger& lhs, const BigInteger& rhs) -> BigInteger;
+    static auto modInverse(const BigInteger& number, const BigInteger& modulus) -> BigInteger;
+    bool isProbablePrime(std::size_t rounds = 20) const;
+
 private:
-    static constexpr int BASE = 10;
+    using Limb = std::uint32_t;
+    using DoubleLimb = std::uint64_t; // holds a product of two limbs plus two limbs
+    static constexpr int LIMB_BITS = 32;
+
+    // Strings are converted in chunks of as many digits as fit in a limb (9 decimal digits). Numbers
+    // of more limbs are split in halves by dividing by cached powers of the base.
+    static constexpr std::size_t CONVERSION_THRESHOLD = 32;
+
+    // Operands with fewer limbs are multiplied by long multiplication, larger ones by Karatsuba
+    // and from TOOM3_THRESHOLD limbs on by Toom-3.
+    static constexpr std::size_t KARATSUBA_THRESHOLD = 32;
+    static constexpr std::size_t TOOM3_THRESHOLD = 128;
+
+    // Divisors and quotients of at least this many limbs are divided by Burnikel-Ziegler.
+    static constexpr std::size_t BURNIKEL_ZIEGLER_THRESHOLD = 80;
 
-    std::vector<int> digits_; // digits are stored in reversed order
+    class Montgomery;
+
+    std::vector<Limb> limbs_; // base 2^32 limbs of the absolute value stored in reversed order
     bool sign_ = true;
 
+    static int compareMagnitudes(const BigInteger& lhs, const BigInteger& rhs);
+    void addMagnitude(const BigInteger& other);
+    void subtractMagnitude(const BigInteger& other);
+    void multiplySmall(Limb factor, Limb addend = 0);
+    auto divideSmall(Limb divisor) -> Limb;
+    auto magnitude() const -> BigInteger;
+    auto bitCnt() const -> std::size_t;
+    void shiftLeft(std::size_t bits);
+    void shiftRight(std::size_t bits);
+
+    static auto multiplyLong(const BigInteger& lhs, const BigInteger& rhs) -> BigInteger;
+    static auto multiplyKaratsuba(const BigInteger& lhs, const BigInteger& rhs) -> BigInteger;
+    static auto multiplyToom3(const BigInteger& lhs, const BigInteger& rhs) -> BigInteger;
+    static auto divideMagnitudes(const BigInteger& lhs, const BigInteger& rhs) -> std::pair<BigInteger, BigInteger>;
+    static auto divideKnuth(const BigInteger& lhs, const BigInteger& rhs) -> std::pair<BigInteger, BigInteger>;
+    static auto divideBurnikelZiegler(const BigInteger& lhs, const BigInteger& rhs) -> std::pair<BigInteger, BigInteger>;
+    static auto divide2n1n(const BigInteger& lhs, const BigInteger& rhs, std::size_t n) -> std::pair<BigInteger, BigInteger>;
+    static auto divide3n2n(const BigInteger& lhs, const BigInteger& rhs, std::size_t half) -> std::pair<BigInteger, BigInteger>;
+    static auto radixChunk(int base) -> std::pair<std::size_t, Limb>;
+    static auto radixPowers(int base, std::size_t digitCnt) -> std::vector<BigInteger>;
+    static auto parse(const char* first, const char* last, int base, const std::vector<BigInteger>& powers) -> BigInteger;
+    void format(int base, const std::vector<BigInteger>& powers, std::size_t level, std::size_t width, std::string& out) const;
+
+    auto slice(std::size_t first, std::size_t count) const -> BigInteger;
+    void shiftLimbs(std::size_t count);
+
     void changeSign();
-    void handleCarry();
-    void handleBorrow();
     void removeZeros();
 };
@@ -0,0 +1,309 @@
+#pragma once
+
+#include <array>
+#include <initializer_list>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "Matrix.hpp"
+#include "MatrixExpression.hpp"
+
+// Matrix with dimensions known at compile time, stored inline (on the stack) without any heap
+// allocation. Everything is constexpr and the element loops are expanded at compile time over
+// index sequences, so small transforms compile to straight-line code. A FixedMatrix converts to
+// and from Matrix and can be used in Matrix expressions.
+template <std::size_t R, std::size_t C>
+class FixedMatrix : public MatrixExpression<FixedMatrix<R, C>>
+{
+    static_assert(R > 0 && C > 0, "Empty matrix");
+
+public:
+    constexpr FixedMatrix() : data_{} {}
+    constexpr FixedMatrix(std::initializer_list<std::initializer_list<double>> data);
+    template <typename E>
+    explicit FixedMatrix(const MatrixExpression<E>& expression);
+
+    static constexpr auto identity() -> FixedMatrix<R, C>;
+
+    static constexpr auto getRowCnt() -> std::size_t { return R; }
+    static constexpr auto getColCnt() -> std::size_t { return C; }
+    constexpr double operator()(std::size_t i, std::size_t j) const { return data_[i * C + j]; }
+    constexpr auto operator()(std::size_t i, std::size_t j) -> double& { return data_[i * C + j]; }
+    constexpr auto operator[](std::size_t i) -> double* { return data_.data() + i * C; }
+    constexpr auto operator[](std::size_t i) const -> const double* { return data_.data() + i * C; }
+    auto print() const -> std::string;
+
+    constexpr bool operator==(const FixedMatrix<R, C>& other) const;
+    constexpr bool operator!=(const FixedMatrix<R, C>& other) const { return !(*this == other); }
+
+    constexpr auto operator+(const FixedMatrix<R, C>& other) const -> FixedMatrix<R, C>;
+    constexpr auto operator-(const FixedMatrix<R, C>& other) const -> FixedMatrix<R, C>;
+    constexpr auto operator-() const -> FixedMatrix<R, C>;
+    constexpr auto operator+(double number) const -> FixedMatrix<R, C>;
+    constexpr auto operator-(double number) const -> FixedMatrix<R, C>;
+    constexpr auto operator*(double number) const -> FixedMatrix<R, C>;
+    constexpr auto operator/(double number) const -> FixedMatrix<R, C>;
+    template <std::size_t K>
+    constexpr auto operator*(const FixedMatrix<C, K>& other) const -> FixedMatrix<R, K>;
+
+    constexpr auto transpose() const -> FixedMatrix<C, R>;
+    constexpr double trace() const;
+    constexpr double determinant() const;
+
+private:
+    static constexpr double EPSILON = 0.000001;
+    static constexpr std::size_t SIZE = R * C;
+
+    std::array<double, SIZE> data_;
+
+    template <typename Op, std::size_t... I>
+    constexpr auto map(Op op, std::index_sequence<I...>) const -> FixedMatrix<R, C>;
+    template <std::size_t K, std::size_t... I>
+    constexpr auto multiply(const FixedMatrix<C, K>& other, std::index_sequence<I...>) const -> FixedMatrix<R, K>;
+    template <std::size_t K, std::size_t... P>
+    constexpr double dot(const FixedMatrix<C, K>& other, std::size_t i, std::size_t j, std::index_sequence<P...>) const;
+
+    template <std::size_t, std::size_t>
+    friend class FixedMatrix;
+};
+
+using Matrix2 = FixedMatrix<2, 2>;
+using Matrix3 = FixedMatrix<3, 3>;
+using Matrix4 = FixedMatrix<4, 4>;
+
+template <std::size_t R, std::size_t C>
+struct ExpressionTraits<FixedMatrix<R, C>>
+{
+    static constexpr bool byReference = true;
+    static constexpr bool ownArithmetic = true;
+};
+
+template <std::size_t R, std::size_t C>
+constexpr FixedMatrix<R, C>::FixedMatrix(std::initializer_list<std::initializer_list<double>> data) :
+    data_{}
+{
+    if (data.size() != R)
+        throw std::runtime_error("Invalid dimensions");
+
+    std::size_t i = 0;
+
+    for (auto row : data)
+    {
+        if (row.size() != C)
+            throw std::runtime_error("Invalid dimensions");
+
+        for (auto element : row)
+            data_[i++] = element;
+    }
+}
+
+template <std::size_t R, std::size_t C>
+template <typename E>
+FixedMatrix<R, C>::FixedMatrix(const MatrixExpression<E>& expression) :
+    data_{}
+{
+    if (expression.getRowCnt() != R || expression.getColCnt() != C)
+        throw std::runtime_error("Invalid dimensions");
+
+    expression.self().evaluateTo(*this);
+}
+
+template <std::size_t R, std::size_t C>
+constexpr auto FixedMatrix<R, C>::identity() -> FixedMatrix<R, C>
+{
+    static_assert(R == C, "Identity of a non-square matrix");
+
+    FixedMatrix<R, C> result;
+    for (std::size_t i = 0; i < R; ++i)
+        result(i, i) = 1;
+
+    return result;
+}
+
+template <std::size_t R, std::size_t C>
+auto FixedMatrix<R, C>::print() const -> std::string
+{
+    std::stringstream out;
+
+    for (std::size_t i = 0; i < R; ++i)
+    {
+        for (std::size_t j = 0; j < C; ++j)
+            out << (*this)(i, j) << (j < C - 1 ? " " : "");
+        out << "\n";
+    }
+
+    return out.str();
+}
+
+template <std::size_t R, std::size_t C>
+constexpr bool FixedMatrix<R, C>::operator==(const FixedMatrix<R, C>& other) const
+{
+    for (std::size_t k = 0; k < SIZE; ++k)
+    {
+        const auto difference = data_[k] - other.data_[k];
+        if (difference >= EPSILON || difference <= -EPSILON)
+            return false;
+    }
+    return true;
+}
+
+template <std::size_t R, std::size_t C>
+template <typename Op, std::size_t... I>
+constexpr auto FixedMatrix<R, C>::map(Op op, std::index_sequence<I...>) const -> FixedMatrix<R, C>
+{
+    FixedMatrix<R, C> result;
+    ((result.data_[I] = op(I)), ...);
+    return result;
+}
+
+template <std::size_t R, std::size_t C>
+constexpr auto FixedMatrix<R, C>::operator+(const FixedMatrix<R, C>& other) const -> FixedMatrix<R, C>
+{
+    return map([&](std::size_t k) { return data_[k] + other.data_[k]; }, std::make_index_sequence<SIZE>());
+}
+
+template <std::size_t R, std::size_t C>
+constexpr auto FixedMatrix<R, C>::operator-(const FixedMatrix<R, C>& other) const -> FixedMatrix<R, C>
+{
+    return map([&](std::size_t k) { return data_[k] - other.data_[k]; }, std::make_index_sequence<SIZE>());
+}
+
+template <std::size_t R, std::size_t C>
+constexpr auto FixedMatrix<R, C>::operator-() const -> FixedMatrix<R, C>
+{
+    return map([&](std::size_t k) { return -data_[k]; }, std::make_index_sequence<SIZE>());
+}
+
+template <std::size_t R, std::size_t C>
+constexpr auto FixedMatrix<R, C>::operator+(double number) const -> FixedMatrix<R, C>
+{
+    return map([&](std::size_t k) { return data_[k] + number; }, std::make_index_sequence<SIZE>());
+}
+
+template <std::size_t R, std::size_t C>
+constexpr auto FixedMatrix<R, C>::operator-(double number) const -> FixedMatrix<R, C>
+{
+    return map([&](std::size_t k) { return data_[k] - number; }, std::make_index_sequence<SIZE>());
+}
+
+template <std::size_t R, std::size_t C>
+constexpr auto FixedMatrix<R, C>::operator*(double number) const -> FixedMatrix<R, C>
+{
+    return map([&](std::size_t k) { return data_[k] * number; }, std::make_index_sequence<SIZE>());
+}
+
+template <std::size_t R, std::size_t C>
+constexpr auto FixedMatrix<R, C>::operator/(double number) const -> FixedMatrix<R, C>
+{
+    return map([&](std::size_t k) { return data_[k] / number; }, std::make_index_sequence<SIZE>());
+}
+
+template <std::size_t R, std::size_t C>
+constexpr auto operator*(double number, const FixedMatrix<R, C>& matrix) -> FixedMatrix<R, C>
+{
+    return matrix * number;
+}
+
+template <std::size_t R, std::size_t C>
+template <std::size_t K, std::size_t... P>
+constexpr double FixedMatrix<R, C>::dot(const FixedMatrix<C, K>& other, std::size_t i, std::size_t j, std::index_sequence<P...>) const
+{
+    return ((data_[i * C + P] * other.data_[P * K + j]) + ...);
+}
+
+template <std::size_t R, std::size_t C>
+template <std::size_t K, std::size_t... I>
+constexpr auto FixedMatrix<R, C>::multiply(const FixedMatrix<C, K>& other, std::index_sequence<I...>) const -> FixedMatrix<R, K>
+{
+    FixedMatrix<R, K> result;
+    ((result.data_[I] = dot(other, I / K, I % K, std::make_index_sequence<C>())), ...);
+    return result;
+}
+
+template <std::size_t R, std::size_t C>
+template <std::size_t K>
+constexpr auto FixedMatrix<R, C>::operator*(const FixedMatrix<C, K>& other) const -> FixedMatrix<R, K>
+{
+    return multiply(other, std::make_index_sequence<R * K>());
+}
+
+template <std::size_t R, std::size_t C>
+constexpr auto FixedMatrix<R, C>::transpose() const -> FixedMatrix<C, R>
+{
+    FixedMatrix<C, R> result;
+
+    for (std::size_t i = 0; i < R; ++i)
+    {
+        for (std::size_t j = 0; j < C; ++j)
+            result(j, i) = (*this)(i, j);
+    }
+
+    return result;
+}
+
+template <std::size_t R, std::size_t C>
+constexpr double FixedMatrix<R, C>::trace() const
+{
+    static_assert(R == C, "Trace of a non-square matrix");
+
+    double trace = 0;
+    for (std::size_t i = 0; i < R; ++i)
+        trace += (*this)(i, i);
+
+    return trace;
+}
+
+// Gaussian elimination with partial pivoting on a copy.
+template <std::size_t R, std::size_t C>
+constexpr double FixedMatrix<R, C>::determinant() const
+{
+    static_assert(R == C, "Determinant of a non-square matrix");
+
+    if constexpr (R == 1)
+        return data_[0];
+    else if constexpr (R == 2)
+        return data_[0] * data_[3] - data_[1] * data_[2];
+    else
+    {
+        auto m = *this;
+        double determinant = 1;
+        const auto magnitude = [](double x) { return x < 0 ? -x : x; }; // std::abs is not constexpr
+
+        for (std::size_t col = 0; col < R; ++col)
+        {
+            auto pivot = col;
+            for (auto i = col + 1; i < R; ++i)
+            {
+                if (magnitude(m(i, col)) > magnitude(m(pivot, col)))
+                    pivot = i;
+            }
+
+            if (m(pivot, col) == 0)
+                return 0;
+
+            if (pivot != col)
+            {
+                for (std::size_t j = 0; j < R; ++j)
+                {
+                    const auto swapped = m(col, j);
+                    m(col, j) = m(pivot, j);
+                    m(pivot, j) = swapped;
+                }
+                determinant = -determinant;
+            }
+
+            determinant *= m(col, col);
+
+            for (auto i = col + 1; i < R; ++i)
+            {
+                const auto multiplier = m(i, col) / m(col, col);
+                for (auto j = col + 1; j < R; ++j)
+                    m(i, j) -= multiplier * m(col, j);
+            }
+        }
+
+        return determinant;
+    }
+}
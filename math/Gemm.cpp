@@ -0,0 +1,226 @@
+#include "Gemm.hpp"
+
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#define GEMM_SIMD_X86 1
+#endif
+
+// The product is computed the way BLIS does it. B is cut into KC x NC blocks that are packed into
+// contiguous NR wide column panels (kept in L3), A into MC x KC blocks packed into MR high row
+// panels (kept in L2), and a micro-kernel multiplies one row panel by one column panel into an
+// MR x NR tile of C held in registers, streaming both panels from L1.
+namespace
+{
+constexpr std::size_t MR = 6;
+constexpr std::size_t NR = 8;
+constexpr std::size_t MC = 96;
+constexpr std::size_t KC = 256;
+constexpr std::size_t NC = 2048;
+
+// Products smaller than this are not worth packing.
+constexpr std::size_t SMALL_PRODUCT = 32 * 32 * 32;
+
+// Minimum work (multiply-adds) per thread.
+constexpr std::size_t PARALLEL_PRODUCT = 128 * 128 * 128;
+
+using Kernel = void (*)(std::size_t kc, const double* a, const double* b, double* tile);
+
+// Computes the MR x NR tile of the product of a row panel and a column panel.
+void genericKernel(std::size_t kc, const double* a, const double* b, double* tile)
+{
+    double acc[MR * NR] = {};
+
+    for (std::size_t p = 0; p < kc; ++p, a += MR, b += NR)
+    {
+        for (std::size_t i = 0; i < MR; ++i)
+        {
+            for (std::size_t j = 0; j < NR; ++j)
+                acc[i * NR + j] += a[i] * b[j];
+        }
+    }
+
+    std::copy(acc, acc + MR * NR, tile);
+}
+
+#ifdef GEMM_SIMD_X86
+// 12 accumulators, 2 for B and 1 for the broadcast of A fit the 16 ymm registers. They are named
+// one by one, with an array the compiler keeps them in memory.
+__attribute__((target("avx2,fma"))) void avx2Kernel(std::size_t kc, const double* a, const double* b, double* tile)
+{
+    auto c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+    auto c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    auto c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+    auto c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+    auto c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+    auto c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+
+    for (std::size_t p = 0; p < kc; ++p, a += MR, b += NR)
+    {
+        const auto b0 = _mm256_loadu_pd(b);
+        const auto b1 = _mm256_loadu_pd(b + 4);
+        __m256d ai;
+
+        ai = _mm256_broadcast_sd(a);
+        c00 = _mm256_fmadd_pd(ai, b0, c00);
+        c01 = _mm256_fmadd_pd(ai, b1, c01);
+        ai = _mm256_broadcast_sd(a + 1);
+        c10 = _mm256_fmadd_pd(ai, b0, c10);
+        c11 = _mm256_fmadd_pd(ai, b1, c11);
+        ai = _mm256_broadcast_sd(a + 2);
+        c20 = _mm256_fmadd_pd(ai, b0, c20);
+        c21 = _mm256_fmadd_pd(ai, b1, c21);
+        ai = _mm256_broadcast_sd(a + 3);
+        c30 = _mm256_fmadd_pd(ai, b0, c30);
+        c31 = _mm256_fmadd_pd(ai, b1, c31);
+        ai = _mm256_broadcast_sd(a + 4);
+        c40 = _mm256_fmadd_pd(ai, b0, c40);
+        c41 = _mm256_fmadd_pd(ai, b1, c41);
+        ai = _mm256_broadcast_sd(a + 5);
+        c50 = _mm256_fmadd_pd(ai, b0, c50);
+        c51 = _mm256_fmadd_pd(ai, b1, c51);
+    }
+
+    _mm256_storeu_pd(tile, c00);
+    _mm256_storeu_pd(tile + 4, c01);
+    _mm256_storeu_pd(tile + 8, c10);
+    _mm256_storeu_pd(tile + 12, c11);
+    _mm256_storeu_pd(tile + 16, c20);
+    _mm256_storeu_pd(tile + 20, c21);
+    _mm256_storeu_pd(tile + 24, c30);
+    _mm256_storeu_pd(tile + 28, c31);
+    _mm256_storeu_pd(tile + 32, c40);
+    _mm256_storeu_pd(tile + 36, c41);
+    _mm256_storeu_pd(tile + 40, c50);
+    _mm256_storeu_pd(tile + 44, c51);
+}
+#endif
+
+auto selectKernel() -> Kernel
+{
+#ifdef GEMM_SIMD_X86
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return avx2Kernel;
+#endif
+    return genericKernel;
+}
+
+// Row panels of MR rows, each stored column by column. Missing rows are padded with zeros.
+void packA(std::size_t mc, std::size_t kc, const double* a, std::size_t lda, double* packed)
+{
+    for (std::size_t ir = 0; ir < mc; ir += MR)
+    {
+        const auto rows = std::min(MR, mc - ir);
+
+        for (std::size_t p = 0; p < kc; ++p, packed += MR)
+        {
+            for (std::size_t i = 0; i < MR; ++i)
+                packed[i] = i < rows ? a[(ir + i) * lda + p] : 0;
+        }
+    }
+}
+
+// Column panels of NR columns, each stored row by row. Missing columns are padded with zeros.
+void packB(std::size_t kc, std::size_t nc, const double* b, std::size_t ldb, double* packed)
+{
+    for (std::size_t jr = 0; jr < nc; jr += NR)
+    {
+        const auto cols = std::min(NR, nc - jr);
+
+        for (std::size_t p = 0; p < kc; ++p, packed += NR)
+        {
+            const auto* row = b + p * ldb + jr;
+            for (std::size_t j = 0; j < NR; ++j)
+                packed[j] = j < cols ? row[j] : 0;
+        }
+    }
+}
+
+void blockedGemm(std::size_t m, std::size_t n, std::size_t k, double alpha, const double* a, std::size_t lda, const double* b, std::size_t ldb, double* c, std::size_t ldc)
+{
+    static const Kernel kernel = selectKernel();
+
+    std::vector<double> packedA(MC * KC);
+    std::vector<double> packedB(KC * ((std::min(n, NC) + NR - 1) / NR * NR));
+    double tile[MR * NR];
+
+    for (std::size_t jc = 0; jc < n; jc += NC)
+    {
+        const auto nc = std::min(NC, n - jc);
+
+        for (std::size_t pc = 0; pc < k; pc += KC)
+        {
+            const auto kc = std::min(KC, k - pc);
+            packB(kc, nc, b + pc * ldb + jc, ldb, packedB.data());
+
+            for (std::size_t ic = 0; ic < m; ic += MC)
+            {
+                const auto mc = std::min(MC, m - ic);
+                packA(mc, kc, a + ic * lda + pc, lda, packedA.data());
+
+                for (std::size_t jr = 0; jr < nc; jr += NR)
+                {
+                    const auto cols = std::min(NR, nc - jr);
+
+                    for (std::size_t ir = 0; ir < mc; ir += MR)
+                    {
+                        const auto rows = std::min(MR, mc - ir);
+                        kernel(kc, packedA.data() + ir * kc, packedB.data() + jr * kc, tile);
+
+                        for (std::size_t i = 0; i < rows; ++i)
+                        {
+                            auto* row = c + (ic + ir + i) * ldc + jc + jr;
+                            for (std::size_t j = 0; j < cols; ++j)
+                                row[j] += alpha * tile[i * NR + j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void naiveGemm(std::size_t m, std::size_t n, std::size_t k, double alpha, const double* a, std::size_t lda, const double* b, std::size_t ldb, double* c, std::size_t ldc)
+{
+    for (std::size_t i = 0; i < m; ++i)
+    {
+        for (std::size_t p = 0; p < k; ++p)
+        {
+            const auto aip = alpha * a[i * lda + p];
+            for (std::size_t j = 0; j < n; ++j)
+                c[i * ldc + j] += aip * b[p * ldb + j];
+        }
+    }
+}
+
+} // namespace
+
+// Large products are split into bands of rows of C computed in parallel. Every band packs B on
+// its own, which costs a fraction of its multiplication work proportional to 1 / band height.
+void gemm(std::size_t m, std::size_t n, std::size_t k, double alpha, const double* a, std::size_t lda, const double* b, std::size_t ldb, double* c, std::size_t ldc)
+{
+    const auto work = m * n * k;
+    if (work <= SMALL_PRODUCT)
+        return naiveGemm(m, n, k, alpha, a, lda, b, ldb, c, ldc);
+
+    const std::size_t hardware = std::max(std::thread::hardware_concurrency(), 1u);
+    const auto threads = std::min({ hardware, work / PARALLEL_PRODUCT + 1, (m + MR - 1) / MR });
+
+    if (threads <= 1)
+        return blockedGemm(m, n, k, alpha, a, lda, b, ldb, c, ldc);
+
+    const auto band = (m / threads + MR - 1) / MR * MR;
+    std::vector<std::future<void>> tasks;
+
+    for (std::size_t i = band; i < m; i += band)
+        tasks.push_back(std::async(std::launch::async, blockedGemm, std::min(band, m - i), n, k, alpha, a + i * lda, lda, b, ldb, c + i * ldc, ldc));
+
+    blockedGemm(std::min(band, m), n, k, alpha, a, lda, b, ldb, c, ldc);
+
+    for (auto& task : tasks)
+        task.get();
+}
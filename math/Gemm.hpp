@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstddef>
+
+// General matrix multiplication C += alpha * A * B of row-major matrices, where A is m x k, B is
+// k x n and C is m x n. Consecutive rows of a matrix are lda (ldb, ldc) elements apart. C must not
+// overlap A or B.
+void gemm(std::size_t m, std::size_t n, std::size_t k, double alpha, const double* a, std::size_t lda, const double* b, std::size_t ldb, double* c, std::size_t ldc);
@@ -0,0 +1,223 @@
+#include "LUDecomposition.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include "Gemm.hpp"
+
+// The factorization is blocked like LAPACK getrf: a panel of BLOCK columns is eliminated column by
+// column, then the rows of U right of the panel are finished by a triangular solve and the rest
+// of the matrix is updated by a single matrix product, which does almost all of the work.
+LUDecomposition::LUDecomposition(const Matrix& m) :
+    lu_(m),
+    permutation_(m.getRowCnt())
+{
+    std::iota(permutation_.begin(), permutation_.end(), 0);
+
+    const auto rowCnt = lu_.getRowCnt();
+    const auto colCnt = lu_.getColCnt();
+    double maxElement = 0;
+
+    for (std::size_t i = 0; i < rowCnt; ++i)
+    {
+        for (std::size_t j = 0; j < colCnt; ++j)
+            maxElement = std::max(maxElement, std::abs(lu_.row(i)[j]));
+    }
+
+    // Pivots this small compared to the matrix are rounding errors of a zero. Each elimination step
+    // adds an error of up to about size * epsilon, hence the square.
+    const auto size = static_cast<double>(std::max(rowCnt, colCnt));
+    const auto tolerance = size * size * std::numeric_limits<double>::epsilon() * maxElement;
+
+    for (std::size_t col = 0; col < colCnt && rank() < rowCnt; col += BLOCK)
+    {
+        const auto colEnd = std::min(col + BLOCK, colCnt);
+        const auto rowBegin = rank();
+
+        factorPanel(col, colEnd, tolerance);
+        updateTrailing(rowBegin, colEnd);
+    }
+}
+
+// Gaussian elimination restricted to the columns of the panel. Whole rows are swapped, so the
+// already computed part of L follows its rows.
+void LUDecomposition::factorPanel(std::size_t colBegin, std::size_t colEnd, double tolerance)
+{
+    const auto rowCnt = lu_.getRowCnt();
+
+    for (auto col = colBegin; col < colEnd && rank() < rowCnt; ++col)
+    {
+        const auto r = rank();
+        auto pivot = r;
+
+        for (auto i = r + 1; i < rowCnt; ++i)
+        {
+            if (std::abs(lu_.row(i)[col]) > std::abs(lu_.row(pivot)[col]))
+                pivot = i;
+        }
+
+        if (std::abs(lu_.row(pivot)[col]) <= tolerance) // no pivot in this column
+            continue;
+
+        if (pivot != r)
+        {
+            lu_.swapRow(pivot, r);
+            std::swap(permutation_[pivot], permutation_[r]);
+            sign_ = -sign_;
+        }
+
+        const auto* pivotRow = lu_.row(r);
+
+        for (auto i = r + 1; i < rowCnt; ++i)
+        {
+            auto* current = lu_.row(i);
+            const auto multiplier = current[col] /= pivotRow[col];
+
+            for (auto j = col + 1; j < colEnd; ++j)
+                current[j] -= multiplier * pivotRow[j];
+        }
+
+        pivotCols_.push_back(col);
+    }
+}
+
+// Apply the eliminations of the panel (pivot rows rowBegin up to rank()) to the columns from
+// colEnd on: U12 = L11^-1 * A12 and A22 -= L21 * U12.
+void LUDecomposition::updateTrailing(std::size_t rowBegin, std::size_t colEnd)
+{
+    const auto rowCnt = lu_.getRowCnt();
+    const auto rowEnd = rank();
+    const auto pivots = rowEnd - rowBegin;
+    const auto width = lu_.getColCnt() - colEnd;
+
+    if (pivots == 0 || width == 0)
+        return;
+
+    for (auto i = rowBegin + 1; i < rowEnd; ++i)
+    {
+        auto* target = lu_.row(i) + colEnd;
+
+        for (auto p = rowBegin; p < i; ++p)
+        {
+            const auto multiplier = lu_.row(i)[pivotCols_[p]];
+            const auto* source = lu_.row(p) + colEnd;
+
+            for (std::size_t j = 0; j < width; ++j)
+                target[j] -= multiplier * source[j];
+        }
+    }
+
+    if (rowEnd == rowCnt)
+        return;
+
+    // The multipliers sit in the pivot columns only, gather them into a dense L21.
+    std::vector<double> lower((rowCnt - rowEnd) * pivots);
+
+    for (auto i = rowEnd; i < rowCnt; ++i)
+    {
+        for (std::size_t p = 0; p < pivots; ++p)
+            lower[(i - rowEnd) * pivots + p] = lu_.row(i)[pivotCols_[rowBegin + p]];
+    }
+
+    gemm(rowCnt - rowEnd, width, pivots, -1, lower.data(), pivots, lu_.row(rowBegin) + colEnd, lu_.colDim_, lu_.row(rowEnd) + colEnd, lu_.colDim_);
+}
+
+bool LUDecomposition::isSingular() const
+{
+    return !lu_.isSquare() || rank() < lu_.getRowCnt();
+}
+
+double LUDecomposition::determinant() const
+{
+    if (!lu_.isSquare())
+        throw std::runtime_error("Non-square matrix");
+
+    if (isSingular())
+        return 0;
+
+    double determinant = sign_;
+
+    for (std::size_t i = 0; i < lu_.getRowCnt(); ++i)
+        determinant *= lu_.row(i)[i];
+
+    return determinant;
+}
+
+void LUDecomposition::checkSolvable() const
+{
+    if (!lu_.isSquare())
+        throw std::runtime_error("Non-square matrix");
+
+    if (isSingular())
+        throw std::runtime_error("Singular matrix");
+}
+
+// Solve L * Y = P * B and U * X = Y for all columns of B at once. Both substitutions go by blocks
+// of rows: a block first subtracts the contribution of all solved rows in one matrix product and
+// then is solved within itself.
+auto LUDecomposition::solve(const Matrix& b) const -> Matrix
+{
+    checkSolvable();
+
+    const auto n = lu_.getRowCnt();
+    const auto k = b.getColCnt();
+
+    if (b.getRowCnt() != n)
+        throw std::runtime_error("Invalid dimensions");
+
+    Matrix x(n, k);
+
+    for (std::size_t i = 0; i < n; ++i)
+        std::copy(b.row(permutation_[i]), b.row(permutation_[i]) + k, x.row(i));
+
+    for (std::size_t begin = 0; begin < n; begin += BLOCK)
+    {
+        const auto end = std::min(begin + BLOCK, n);
+        gemm(end - begin, k, begin, -1, lu_.row(begin), lu_.colDim_, x.row(0), x.colDim_, x.row(begin), x.colDim_);
+
+        for (auto i = begin; i < end; ++i)
+        {
+            for (auto p = begin; p < i; ++p)
+            {
+                const auto multiplier = lu_.row(i)[p];
+                for (std::size_t j = 0; j < k; ++j)
+                    x.row(i)[j] -= multiplier * x.row(p)[j];
+            }
+        }
+    }
+
+    for (auto end = n; end > 0;)
+    {
+        const auto begin = (end - 1) / BLOCK * BLOCK;
+        gemm(end - begin, k, n - end, -1, lu_.row(begin) + end, lu_.colDim_, x.row(end), x.colDim_, x.row(begin), x.colDim_);
+
+        for (auto i = end; i-- > begin;)
+        {
+            for (auto p = i + 1; p < end; ++p)
+            {
+                const auto multiplier = lu_.row(i)[p];
+                for (std::size_t j = 0; j < k; ++j)
+                    x.row(i)[j] -= multiplier * x.row(p)[j];
+            }
+
+            for (std::size_t j = 0; j < k; ++j)
+                x.row(i)[j] /= lu_.row(i)[i];
+        }
+
+        end = begin;
+    }
+
+    return x;
+}
+
+auto LUDecomposition::inverse() const -> Matrix
+{
+    checkSolvable();
+
+    Matrix identity(lu_.getRowCnt(), lu_.getColCnt());
+    identity.makeIdentity();
+    return solve(identity);
+}
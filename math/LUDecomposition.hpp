@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+
+#include "Matrix.hpp"
+
+// LU factorization with partial pivoting P * A = L * U of any matrix A, where L is unit lower
+// triangular and U is in row echelon form. Columns without a pivot (all remaining elements are
+// negligible) are skipped, so the number of pivots is the rank of A. The factorization is
+// computed once and reused for the determinant, the inverse and any number of right-hand sides.
+class LUDecomposition
+{
+public:
+    explicit LUDecomposition(const Matrix& m);
+
+    auto rank() const -> std::size_t { return pivotCols_.size(); }
+    bool isSingular() const;
+    double determinant() const;
+    auto solve(const Matrix& b) const -> Matrix;
+    auto inverse() const -> Matrix;
+
+private:
+    static constexpr std::size_t BLOCK = 64;
+
+    Matrix lu_;                            // L below the pivots, U from the pivots up
+    std::vector<std::size_t> permutation_; // row i of lu_ is row permutation_[i] of A
+    std::vector<std::size_t> pivotCols_;   // column of the pivot in row i
+    int sign_ = 1;                         // sign of the permutation
+
+    void factorPanel(std::size_t colBegin, std::size_t colEnd, double tolerance);
+    void updateTrailing(std::size_t rowBegin, std::size_t colEnd);
+    void checkSolvable() const;
+};
@@ -1,13 +1,196 @@
 #include "Matrix.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <new>
 #include <sstream>
 
+#include "LUDecomposition.hpp"
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#define MATRIX_SIMD_X86 1
+#endif
+
+// Transposition splits the longer side in half until the block fits in L1, so both the rows read
+// and the rows written stay in cache at every level without knowing its size. Blocks are moved in
+// 4 x 4 tiles transposed in registers.
+namespace
+{
+// Blocks with both sides up to this are transposed directly.
+constexpr std::size_t TRANSPOSE_BLOCK = 32;
+
+constexpr std::size_t TILE = 4;
+
+using TileKernel = void (*)(const double* src, std::size_t srcStride, double* dest, std::size_t destStride);
+
+void genericTile(const double* src, std::size_t srcStride, double* dest, std::size_t destStride)
+{
+    for (std::size_t i = 0; i < TILE; ++i)
+    {
+        for (std::size_t j = 0; j < TILE; ++j)
+            dest[j * destStride + i] = src[i * srcStride + j];
+    }
+}
+
+#ifdef MATRIX_SIMD_X86
+// Pairs of rows are interleaved within 128 bit lanes, then the lanes are exchanged.
+__attribute__((target("avx"))) void avxTile(const double* src, std::size_t srcStride, double* dest, std::size_t destStride)
+{
+    const auto r0 = _mm256_loadu_pd(src);
+    const auto r1 = _mm256_loadu_pd(src + srcStride);
+    const auto r2 = _mm256_loadu_pd(src + 2 * srcStride);
+    const auto r3 = _mm256_loadu_pd(src + 3 * srcStride);
+
+    const auto t0 = _mm256_unpacklo_pd(r0, r1); // r00 r10 r02 r12
+    const auto t1 = _mm256_unpackhi_pd(r0, r1); // r01 r11 r03 r13
+    const auto t2 = _mm256_unpacklo_pd(r2, r3); // r20 r30 r22 r32
+    const auto t3 = _mm256_unpackhi_pd(r2, r3); // r21 r31 r23 r33
+
+    _mm256_storeu_pd(dest, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(dest + destStride, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(dest + 2 * destStride, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(dest + 3 * destStride, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+#endif
+
+auto selectTileKernel() -> TileKernel
+{
+#ifdef MATRIX_SIMD_X86
+    if (__builtin_cpu_supports("avx"))
+        return avxTile;
+#endif
+    return genericTile;
+}
+
+const TileKernel tileKernel = selectTileKernel();
+
+// Writes the transpose of the rowCnt x colCnt block at src to dest.
+void transposeBlock(const double* src, std::size_t srcStride, double* dest, std::size_t destStride,
+                    std::size_t rowCnt, std::size_t colCnt)
+{
+    if (rowCnt > TRANSPOSE_BLOCK || colCnt > TRANSPOSE_BLOCK)
+    {
+        if (rowCnt >= colCnt)
+        {
+            const auto half = rowCnt / 2 / TILE * TILE;
+            transposeBlock(src, srcStride, dest, destStride, half, colCnt);
+            transposeBlock(src + half * srcStride, srcStride, dest + half, destStride, rowCnt - half, colCnt);
+        }
+        else
+        {
+            const auto half = colCnt / 2 / TILE * TILE;
+            transposeBlock(src, srcStride, dest, destStride, rowCnt, half);
+            transposeBlock(src + half, srcStride, dest + half * destStride, destStride, rowCnt, colCnt - half);
+        }
+        return;
+    }
+
+    const auto tiledRows = rowCnt / TILE * TILE;
+    const auto tiledCols = colCnt / TILE * TILE;
+
+    for (std::size_t i = 0; i < tiledRows; i += TILE)
+    {
+        for (std::size_t j = 0; j < tiledCols; j += TILE)
+            tileKernel(src + i * srcStride + j, srcStride, dest + j * destStride + i, destStride);
+    }
+
+    for (std::size_t i = 0; i < rowCnt; ++i)
+    {
+        for (auto j = i < tiledRows ? tiledCols : 0; j < colCnt; ++j)
+            dest[j * destStride + i] = src[i * srcStride + j];
+    }
+}
+
+// Exchanges the 4 x 4 tiles at a and b, transposing both. For a == b the tile is transposed in place.
+void swapTiles(double* a, double* b, std::size_t stride)
+{
+    double tileA[TILE * TILE];
+    double tileB[TILE * TILE];
+
+    tileKernel(a, stride, tileA, TILE);
+    tileKernel(b, stride, tileB, TILE);
+
+    for (std::size_t i = 0; i < TILE; ++i)
+    {
+        std::copy(tileB + i * TILE, tileB + (i + 1) * TILE, a + i * stride);
+        std::copy(tileA + i * TILE, tileA + (i + 1) * TILE, b + i * stride);
+    }
+}
+
+// Exchanges the rowCnt x colCnt block at (i, j) with the colCnt x rowCnt block at (j, i), transposing
+// both. The blocks must not overlap.
+void swapTransposed(double* data, std::size_t stride, std::size_t i, std::size_t j, std::size_t rowCnt,
+                    std::size_t colCnt)
+{
+    if (rowCnt > TRANSPOSE_BLOCK || colCnt > TRANSPOSE_BLOCK)
+    {
+        if (rowCnt >= colCnt)
+        {
+            const auto half = rowCnt / 2 / TILE * TILE;
+            swapTransposed(data, stride, i, j, half, colCnt);
+            swapTransposed(data, stride, i + half, j, rowCnt - half, colCnt);
+        }
+        else
+        {
+            const auto half = colCnt / 2 / TILE * TILE;
+            swapTransposed(data, stride, i, j, rowCnt, half);
+            swapTransposed(data, stride, i, j + half, rowCnt, colCnt - half);
+        }
+        return;
+    }
+
+    const auto tiledRows = rowCnt / TILE * TILE;
+    const auto tiledCols = colCnt / TILE * TILE;
+
+    for (std::size_t ti = 0; ti < tiledRows; ti += TILE)
+    {
+        for (std::size_t tj = 0; tj < tiledCols; tj += TILE)
+            swapTiles(data + (i + ti) * stride + j + tj, data + (j + tj) * stride + i + ti, stride);
+    }
+
+    for (std::size_t a = 0; a < rowCnt; ++a)
+    {
+        for (auto b = a < tiledRows ? tiledCols : 0; b < colCnt; ++b)
+            std::swap(data[(i + a) * stride + j + b], data[(j + b) * stride + i + a]);
+    }
+}
+
+// Transposes the n x n block on the main diagonal at (i, i) in place: two smaller diagonal blocks
+// and the pair of blocks mirrored across the diagonal.
+void transposeDiagonal(double* data, std::size_t stride, std::size_t i, std::size_t n)
+{
+    if (n > TRANSPOSE_BLOCK)
+    {
+        const auto half = n / 2 / TILE * TILE;
+        transposeDiagonal(data, stride, i, half);
+        transposeDiagonal(data, stride, i + half, n - half);
+        swapTransposed(data, stride, i, i + half, half, n - half);
+        return;
+    }
+
+    const auto tiled = n / TILE * TILE;
+
+    for (std::size_t ti = 0; ti < tiled; ti += TILE)
+    {
+        for (auto tj = ti; tj < tiled; tj += TILE)
+            swapTiles(data + (i + ti) * stride + i + tj, data + (i + tj) * stride + i + ti, stride);
+    }
+
+    for (std::size_t a = 0; a < n; ++a)
+    {
+        for (auto b = a < tiled ? tiled : a + 1; b < n; ++b)
+            std::swap(data[(i + a) * stride + i + b], data[(i + b) * stride + i + a]);
+    }
+}
+
+} // namespace
+
 Matrix::Matrix(std::size_t rowCnt, std::size_t colCnt, double element) :
     rowCnt_(rowCnt),
     colCnt_(colCnt),
     rowDim_(updateSize(rowCnt_)),
-    colDim_(updateSize(colCnt_))
+    colDim_(updateColSize(colCnt_))
 {
     alloc();
 
@@ -15,7 +198,7 @@ Matrix::Matrix(std::size_t rowCnt, std::size_t colCnt, double element) :
     {
         for (std::size_t j = 0; j < colCnt_; ++j)
         {
-            data_[i][j] = element;
+            row(i)[j] = element;
         }
     }
 }
@@ -24,18 +207,18 @@ Matrix::Matrix(std::initializer_list<std::initializer_list<double>> data) :
     rowCnt_(data.size()),
     colCnt_(data.size() > 0 ? data.begin()->size() : 0),
     rowDim_(updateSize(rowCnt_)),
-    colDim_(updateSize(colCnt_))
+    colDim_(updateColSize(colCnt_))
 {
     alloc();
 
     std::size_t i = 0;
     std::size_t j = 0;
 
-    for (auto row : data)
+    for (auto list : data)
     {
-        for (auto element : row)
+        for (auto element : list)
         {
-            data_[i][j] = element;
+            row(i)[j] = element;
             ++j;
         }
 
@@ -44,6 +227,15 @@ Matrix::Matrix(std::initializer_list<std::initializer_list<double>> data) :
     }
 }
 
+Matrix::Matrix(std::size_t rowCnt, std::size_t colCnt, Uninitialized) :
+    rowCnt_(rowCnt),
+    colCnt_(colCnt),
+    rowDim_(updateSize(rowCnt_)),
+    colDim_(updateColSize(colCnt_))
+{
+    alloc();
+}
+
 Matrix::Matrix(const Matrix& other) :
     rowCnt_(other.rowCnt_),
     colCnt_(other.colCnt_),
@@ -53,12 +245,7 @@ Matrix::Matrix(const Matrix& other) :
     alloc();
 
     for (std::size_t i = 0; i < rowCnt_; ++i)
-    {
-        for (std::size_t j = 0; j < colCnt_; ++j)
-        {
-            data_[i][j] = other.data_[i][j];
-        }
-    }
+        std::copy(other.row(i), other.row(i) + colCnt_, row(i));
 }
 
 Matrix::Matrix(Matrix&& other) noexcept
@@ -99,15 +286,25 @@ auto Matrix::updateSize(std::size_t s) const -> std::size_t
     return s + SIZE - s % SIZE;
 }
 
+// The column capacity is also the row stride, it is rounded up to whole cache lines so that every
+// row starts aligned.
+auto Matrix::updateColSize(std::size_t s) const -> std::size_t
+{
+    constexpr std::size_t lineElements = ALIGNMENT / sizeof(double);
+    return (updateSize(s) + lineElements - 1) / lineElements * lineElements;
+}
+
+auto Matrix::allocate(std::size_t rowDim, std::size_t colDim) -> double*
+{
+    return static_cast<double*>(::operator new(rowDim * colDim * sizeof(double), std::align_val_t(ALIGNMENT)));
+}
+
 void Matrix::alloc()
 {
-    data_ = new double* [rowDim_];
-    for (std::size_t i = 0; i < rowDim_; ++i)
-    {
-        data_[i] = new double[colDim_];
-    }
+    data_ = allocate(rowDim_, colDim_);
 }
 
+// All rows are stored in a single buffer, one after another every colDim_ elements.
 // The matrix allocates more memory than the current row/col count to support 
 // insertion/removal of the data. The size is determined as row/col count rounded up
 // to the nearest multiple of SIZE variable (both dimensions can have different sizes).
@@ -116,24 +313,15 @@ void Matrix::alloc()
 void Matrix::resize()
 {
     std::size_t newRowDim = updateSize(rowCnt_);
-    std::size_t newColDim = updateSize(colCnt_);
+    std::size_t newColDim = updateColSize(colCnt_);
 
     if (newRowDim == rowDim_ && newColDim == colDim_)
         return;
 
-    double** newData = new double* [newRowDim];
-    for (std::size_t i = 0; i < newRowDim; ++i)
-    {
-        newData[i] = new double[newColDim];
-    }
+    double* newData = allocate(newRowDim, newColDim);
 
     for (std::size_t i = 0; i < rowCnt_; ++i)
-    {
-        for (std::size_t j = 0; j < colCnt_; ++j)
-        {
-            newData[i][j] = data_[i][j];
-        }
-    }
+        std::copy(row(i), row(i) + colCnt_, newData + i * newColDim);
 
     cleanup();
     data_ = newData;
@@ -143,12 +331,7 @@ void Matrix::resize()
 
 void Matrix::cleanup()
 {
-    for (std::size_t i = 0; i < rowDim_; ++i)
-    {
-        delete[] data_[i];
-    }
-
-    delete[] data_;
+    ::operator delete(data_, std::align_val_t(ALIGNMENT));
     data_ = nullptr;
 }
 
@@ -166,7 +349,7 @@ bool Matrix::operator==(const Matrix& other) const
     {
         for (std::size_t j = 0; j < colCnt_; ++j)
         {
-            if (!isSameElement(data_[i][j], other.data_[i][j]))
+            if (!isSameElement(row(i)[j], other.row(i)[j]))
                 return false;
         }
     }
@@ -183,7 +366,7 @@ auto Matrix::operator[](std::size_t i) -> double*
     if (i >= rowCnt_)
         throw std::runtime_error("Index out of range");
 
-    return data_[i];
+    return row(i);
 }
 
 auto Matrix::operator[](std::size_t i) const -> const double*
@@ -191,7 +374,7 @@ auto Matrix::operator[](std::size_t i) const -> const double*
     if (i >= rowCnt_)
         throw std::runtime_error("Index out of range");
 
-    return data_[i];
+    return row(i);
 }
 
 auto Matrix::print(bool debug) const -> std::string
@@ -203,7 +386,7 @@ auto Matrix::print(bool debug) const -> std::string
         for (std::size_t i = 0; i < rowCnt_; ++i)
         {
             for (std::size_t j = 0; j < colCnt_; ++j)
-                out << data_[i][j] << (j < colCnt_ - 1 ? " " : "");
+                out << row(i)[j] << (j < colCnt_ - 1 ? " " : "");
             out << "\n";
         }
     }
@@ -249,63 +432,6 @@ auto Matrix::operator/=(double number) -> Matrix&
     return *this;
 }
 
-auto Matrix::operator+(const Matrix& other) const -> Matrix
-{
-    if (!isSameDim(other))
-        throw std::runtime_error("Invalid dimensions");
-
-    Matrix result = *this;
-
-    for (std::size_t i = 0; i < result.rowCnt_; ++i)
-    {
-        for (std::size_t j = 0; j < result.colCnt_; ++j)
-        {
-            result.data_[i][j] += other.data_[i][j];
-        }
-    }
-
-    return result;
-}
-
-auto Matrix::operator-(const Matrix& other) const -> Matrix
-{
-    if (!isSameDim(other))
-        throw std::runtime_error("Invalid dimensions");
-
-    Matrix result = *this;
-
-    for (std::size_t i = 0; i < result.rowCnt_; ++i)
-    {
-        for (std::size_t j = 0; j < result.colCnt_; ++j)
-        {
-            result.data_[i][j] -= other.data_[i][j];
-        }
-    }
-
-    return result;
-}
-
-auto Matrix::operator*(const Matrix& other) const -> Matrix
-{
-    if (colCnt_ != other.rowCnt_)
-        throw std::runtime_error("Invalid dimensions");
-
-    Matrix result(rowCnt_, other.colCnt_);
-
-    for (std::size_t i = 0; i < result.rowCnt_; ++i)
-    {
-        for (std::size_t j = 0; j < result.colCnt_; ++j)
-        {
-            for (std::size_t k = 0; k < colCnt_; ++k)
-            {
-                result.data_[i][j] += data_[i][k] * other.data_[k][j];
-            }
-        }
-    }
-
-    return result;
-}
-
 bool Matrix::isRowZero(std::size_t i) const
 {
     if (i >= rowCnt_)
@@ -313,7 +439,7 @@ bool Matrix::isRowZero(std::size_t i) const
 
     for (std::size_t j = 0; j < colCnt_; ++j)
     {
-        if (data_[i][j] != 0)
+        if (row(i)[j] != 0)
             return false;
     }
     return true;
@@ -324,14 +450,14 @@ void Matrix::swapRow(std::size_t i1, std::size_t i2)
     if (i1 >= rowCnt_ || i2 >= rowCnt_)
         throw std::runtime_error("Index out of range");
 
-    std::swap(data_[i1], data_[i2]);
+    std::swap_ranges(row(i1), row(i1) + colCnt_, row(i2));
 }
 
 void Matrix::appendRow(double element)
 {
     for (std::size_t j = 0; j < colCnt_; ++j)
     {
-        data_[rowCnt_][j] = element;
+        row(rowCnt_)[j] = element;
     }
 
     ++rowCnt_;
@@ -343,13 +469,8 @@ void Matrix::removeRow(std::size_t iRem)
     if (iRem >= rowCnt_)
         throw std::runtime_error("Index out of range");
 
-    for (std::size_t i = iRem; i < rowCnt_; ++i)
-    {
-        for (std::size_t j = 0; j < colCnt_; ++j)
-        {
-            data_[i][j] = data_[i + 1][j];
-        }
-    }
+    for (std::size_t i = iRem; i + 1 < rowCnt_; ++i)
+        std::copy(row(i + 1), row(i + 1) + colCnt_, row(i));
 
     --rowCnt_;
     resize();
@@ -361,7 +482,7 @@ void Matrix::addToRow(std::size_t i, double number)
         throw std::runtime_error("Index out of range");
 
     for (std::size_t j = 0; j < colCnt_; ++j)
-        data_[i][j] += number;
+        row(i)[j] += number;
 }
 
 void Matrix::substractFromRow(std::size_t i, double number)
@@ -370,7 +491,7 @@ void Matrix::substractFromRow(std::size_t i, double number)
         throw std::runtime_error("Index out of range");
 
     for (std::size_t j = 0; j < colCnt_; ++j)
-        data_[i][j] -= number;
+        row(i)[j] -= number;
 }
 
 void Matrix::multiplyRow(std::size_t i, double number)
@@ -379,7 +500,7 @@ void Matrix::multiplyRow(std::size_t i, double number)
         throw std::runtime_error("Index out of range");
 
     for (std::size_t j = 0; j < colCnt_; ++j)
-        data_[i][j] *= number;
+        row(i)[j] *= number;
 }
 
 void Matrix::divideRow(std::size_t i, double number)
@@ -388,7 +509,7 @@ void Matrix::divideRow(std::size_t i, double number)
         throw std::runtime_error("Index out of range");
 
     for (std::size_t j = 0; j < colCnt_; ++j)
-        data_[i][j] /= number;
+        row(i)[j] /= number;
 }
 
 void Matrix::addRowToRow(std::size_t i1, std::size_t i2, double multiplier)
@@ -397,7 +518,7 @@ void Matrix::addRowToRow(std::size_t i1, std::size_t i2, double multiplier)
         throw std::runtime_error("Index out of range");
 
     for (std::size_t j = 0; j < colCnt_; ++j)
-        data_[i2][j] += multiplier * data_[i1][j];
+        row(i2)[j] += multiplier * row(i1)[j];
 }
 
 void Matrix::substractRowFromRow(std::size_t i1, std::size_t i2, double multiplier)
@@ -406,7 +527,7 @@ void Matrix::substractRowFromRow(std::size_t i1, std::size_t i2, double multipli
         throw std::runtime_error("Index out of range");
 
     for (std::size_t j = 0; j < colCnt_; ++j)
-        data_[i2][j] -= multiplier * data_[i1][j];
+        row(i2)[j] -= multiplier * row(i1)[j];
 }
 
 void Matrix::multiplyRowByRow(std::size_t i1, std::size_t i2, double multiplier)
@@ -415,7 +536,7 @@ void Matrix::multiplyRowByRow(std::size_t i1, std::size_t i2, double multiplier)
         throw std::runtime_error("Index out of range");
 
     for (std::size_t j = 0; j < colCnt_; ++j)
-        data_[i2][j] *= multiplier * data_[i1][j];
+        row(i2)[j] *= multiplier * row(i1)[j];
 }
 
 void Matrix::divideRowByRow(std::size_t i1, std::size_t i2, double multiplier)
@@ -424,7 +545,7 @@ void Matrix::divideRowByRow(std::size_t i1, std::size_t i2, double multiplier)
         throw std::runtime_error("Index out of range");
 
     for (std::size_t j = 0; j < colCnt_; ++j)
-        data_[i2][j] /= multiplier * data_[i1][j];
+        row(i2)[j] /= multiplier * row(i1)[j];
 }
 
 bool Matrix::isColZero(std::size_t j) const
@@ -434,7 +555,7 @@ bool Matrix::isColZero(std::size_t j) const
 
     for (std::size_t i = 0; i < rowCnt_; ++i)
     {
-        if (data_[i][j] != 0)
+        if (row(i)[j] != 0)
             return false;
     }
     return true;
@@ -446,14 +567,14 @@ void Matrix::swapCol(std::size_t j1, std::size_t j2)
         throw std::runtime_error("Index out of range");
 
     for (std::size_t i = 0; i < rowCnt_; ++i)
-        std::swap(data_[i][j1], data_[i][j2]);
+        std::swap(row(i)[j1], row(i)[j2]);
 }
 
 void Matrix::appendCol(double element)
 {
     for (std::size_t i = 0; i < rowCnt_; ++i)
     {
-        data_[i][colCnt_] = element;
+        row(i)[colCnt_] = element;
     }
 
     ++colCnt_;
@@ -467,9 +588,9 @@ void Matrix::removeCol(std::size_t jRem)
 
     for (std::size_t i = 0; i < rowCnt_; ++i)
     {
-        for (std::size_t j = jRem; j < colCnt_; ++j)
+        for (std::size_t j = jRem; j + 1 < colCnt_; ++j)
         {
-            data_[i][j] = data_[i][j + 1];
+            row(i)[j] = row(i)[j + 1];
         }
     }
 
@@ -483,7 +604,7 @@ void Matrix::addToCol(std::size_t j, double number)
         throw std::runtime_error("Index out of range");
 
     for (std::size_t i = 0; i < rowCnt_; ++i)
-        data_[i][j] += number;
+        row(i)[j] += number;
 }
 
 void Matrix::substractFromCol(std::size_t j, double number)
@@ -492,7 +613,7 @@ void Matrix::substractFromCol(std::size_t j, double number)
         throw std::runtime_error("Index out of range");
 
     for (std::size_t i = 0; i < rowCnt_; ++i)
-        data_[i][j] -= number;
+        row(i)[j] -= number;
 }
 
 void Matrix::multiplyCol(std::size_t j, double number)
@@ -501,7 +622,7 @@ void Matrix::multiplyCol(std::size_t j, double number)
         throw std::runtime_error("Index out of range");
 
     for (std::size_t i = 0; i < rowCnt_; ++i)
-        data_[i][j] *= number;
+        row(i)[j] *= number;
 }
 
 void Matrix::divideCol(std::size_t j, double number)
@@ -510,7 +631,7 @@ void Matrix::divideCol(std::size_t j, double number)
         throw std::runtime_error("Index out of range");
 
     for (std::size_t i = 0; i < rowCnt_; ++i)
-        data_[i][j] /= number;
+        row(i)[j] /= number;
 }
 
 void Matrix::addColToCol(std::size_t j1, std::size_t j2, double multiplier)
@@ -519,7 +640,7 @@ void Matrix::addColToCol(std::size_t j1, std::size_t j2, double multiplier)
         throw std::runtime_error("Index out of range");
 
     for (std::size_t i = 0; i < rowCnt_; ++i)
-        data_[i][j2] += multiplier * data_[i][j1];
+        row(i)[j2] += multiplier * row(i)[j1];
 }
 
 void Matrix::substractColFromCol(std::size_t j1, std::size_t j2, double multiplier)
@@ -528,7 +649,7 @@ void Matrix::substractColFromCol(std::size_t j1, std::size_t j2, double multipli
         throw std::runtime_error("Index out of range");
 
     for (std::size_t i = 0; i < rowCnt_; ++i)
-        data_[i][j2] -= multiplier * data_[i][j1];
+        row(i)[j2] -= multiplier * row(i)[j1];
 }
 
 void Matrix::multiplyColByCol(std::size_t j1, std::size_t j2, double multiplier)
@@ -537,7 +658,7 @@ void Matrix::multiplyColByCol(std::size_t j1, std::size_t j2, double multiplier)
         throw std::runtime_error("Index out of range");
 
     for (std::size_t i = 0; i < rowCnt_; ++i)
-        data_[i][j2] *= multiplier * data_[i][j1];
+        row(i)[j2] *= multiplier * row(i)[j1];
 }
 
 void Matrix::divideColByCol(std::size_t j1, std::size_t j2, double multiplier)
@@ -546,7 +667,7 @@ void Matrix::divideColByCol(std::size_t j1, std::size_t j2, double multiplier)
         throw std::runtime_error("Index out of range");
 
     for (std::size_t i = 0; i < rowCnt_; ++i)
-        data_[i][j2] /= multiplier * data_[i][j1];
+        row(i)[j2] /= multiplier * row(i)[j1];
 }
 
 bool Matrix::isSameDim(const Matrix& other) const
@@ -578,7 +699,7 @@ bool Matrix::isDiagonal() const
     {
         for (std::size_t j = 0; j < colCnt_; ++j)
         {
-            if (i != j && data_[i][j] != 0 || i == j && data_[i][j] == 0)
+            if (i != j && row(i)[j] != 0 || i == j && row(i)[j] == 0)
                 return false;
         }
     }
@@ -594,7 +715,7 @@ bool Matrix::isIdentity() const
     {
         for (std::size_t j = 0; j < colCnt_; ++j)
         {
-            if (i != j && data_[i][j] != 0 || i == j && data_[i][j] != 1)
+            if (i != j && row(i)[j] != 0 || i == j && row(i)[j] != 1)
                 return false;
         }
     }
@@ -610,7 +731,7 @@ bool Matrix::isSymmetrical() const
     {
         for (std::size_t j = i + 1; j < colCnt_; ++j)
         {
-            if (data_[i][j] != data_[j][i])
+            if (row(i)[j] != row(j)[i])
                 return false;
         }
     }
@@ -626,7 +747,7 @@ bool Matrix::isLowerTriangular() const
     {
         for (std::size_t j = 0; j < i; ++j)
         {
-            if (data_[i][j] != 0)
+            if (row(i)[j] != 0)
                 return false;
         }
     }
@@ -642,7 +763,7 @@ bool Matrix::isUpperTriangular() const
     {
         for (std::size_t j = i + 1; j < colCnt_; ++j)
         {
-            if (data_[i][j] != 0)
+            if (row(i)[j] != 0)
                 return false;
         }
     }
@@ -656,7 +777,7 @@ bool Matrix::isTriangular() const
 
 bool Matrix::isSingular() const
 {
-    return isSquare() && determinant() == 0;
+    return isSquare() && LUDecomposition(*this).isSingular();
 }
 
 bool Matrix::isSparse() const
@@ -678,7 +799,7 @@ bool Matrix::isRowEchelonForm() const
         {
             std::size_t curZeros = 0;
 
-            for (std::size_t j = 0; j < colCnt_ && data_[i][j] == 0; ++j) // count zeros before pivot
+            for (std::size_t j = 0; j < colCnt_ && row(i)[j] == 0; ++j) // count zeros before pivot
                 ++curZeros;
 
             // check if the current row has more zeros than the previous row (skip for the first row)
@@ -712,15 +833,15 @@ bool Matrix::isReducedRowEchelonForm() const
     {
         for (std::size_t j = 0; j < colCnt_; ++j)
         {
-            if (data_[i][j] == 0)
+            if (row(i)[j] == 0)
                 continue;
 
-            if (data_[i][j] != 1) // check if the pivot is 1
+            if (row(i)[j] != 1) // check if the pivot is 1
                 return false;
 
             for (std::size_t i2 = 0; i2 < rowCnt_; ++i2) // check if the pivot is the only non-zero element in its column
             {
-                if (data_[i2][j] != 0 && i2 != i)
+                if (row(i2)[j] != 0 && i2 != i)
                     return false;
             }
 
@@ -740,7 +861,7 @@ void Matrix::makeIdentity()
     {
         for (std::size_t j = 0; j < colCnt_; ++j)
         {
-            data_[i][j] = i == j;
+            row(i)[j] = i == j;
         }
     }
 }
@@ -751,7 +872,7 @@ void Matrix::autofill(double element)
     {
         for (std::size_t j = 0; j < colCnt_; ++j)
         {
-            data_[i][j] = element++;
+            row(i)[j] = element++;
         }
     }
 }
@@ -766,17 +887,17 @@ auto Matrix::submatrix(std::size_t i, std::size_t j) const -> Matrix
 
 auto Matrix::transpose() const -> Matrix
 {
-    Matrix result(colCnt_, rowCnt_);
+    Matrix result(colCnt_, rowCnt_, Uninitialized{});
+    transposeBlock(data_, colDim_, result.data_, result.colDim_, rowCnt_, colCnt_);
+    return result;
+}
 
-    for (std::size_t i = 0; i < colCnt_; ++i)
-    {
-        for (std::size_t j = 0; j < rowCnt_; ++j)
-        {
-            result.data_[i][j] = data_[j][i];
-        }
-    }
+void Matrix::transposeInPlace()
+{
+    if (!isSquare())
+        throw std::runtime_error("Non-square matrix");
 
-    return result;
+    transposeDiagonal(data_, colDim_, 0, rowCnt_);
 }
 
 // Calculate the sum of elements on the main diagonal of square matrix.
@@ -788,13 +909,13 @@ double Matrix::trace() const
     double trace = 0;
 
     for (std::size_t i = 0; i < rowCnt_; ++i)
-        trace += data_[i][i];
+        trace += row(i)[i];
 
     return trace;
 }
 
-// Implemented as the Laplace expansion. The determinant is calculated as the weighted sum of minors
-// (determinants of the submatrices) using recursion.
+// Small determinants are expanded directly, larger ones are the product of the pivots of the LU
+// decomposition.
 double Matrix::determinant() const
 {
     if (!isSquare())
@@ -802,30 +923,21 @@ double Matrix::determinant() const
 
     if (rowCnt_ == 1)
     {
-        return data_[0][0];
+        return row(0)[0];
     }
     else if (rowCnt_ == 2)
     {
-        return data_[0][0] * data_[1][1] - data_[0][1] * data_[1][0];
+        return row(0)[0] * row(1)[1] - row(0)[1] * row(1)[0];
     }
     else if (rowCnt_ == 3)
     {
-        auto first = data_[0][0] * (data_[1][1] * data_[2][2] - data_[1][2] * data_[2][1]);
-        auto second = data_[0][1] * (data_[1][0] * data_[2][2] - data_[1][2] * data_[2][0]);
-        auto third = data_[0][2] * (data_[1][0] * data_[2][1] - data_[1][1] * data_[2][0]);
+        auto first = row(0)[0] * (row(1)[1] * row(2)[2] - row(1)[2] * row(2)[1]);
+        auto second = row(0)[1] * (row(1)[0] * row(2)[2] - row(1)[2] * row(2)[0]);
+        auto third = row(0)[2] * (row(1)[0] * row(2)[1] - row(1)[1] * row(2)[0]);
         return first - second + third;
     }
 
-    double determinant = 0;
-    int sign = 1;
-
-    for (std::size_t j = 0; j < colCnt_; ++j)
-    {
-        determinant += sign * data_[0][j] * this->submatrix(0, j).determinant();
-        sign *= -1;
-    }
-
-    return determinant;
+    return LUDecomposition(*this).determinant();
 }
 
 double Matrix::sparsity() const
@@ -837,7 +949,7 @@ double Matrix::sparsity() const
     {
         for (std::size_t j = 0; j < colCnt_; ++j)
         {
-            zeroElements += data_[i][j] == 0;
+            zeroElements += row(i)[j] == 0;
         }
     }
 
@@ -846,22 +958,7 @@ double Matrix::sparsity() const
 
 auto Matrix::inverse() const -> Matrix
 {
-    if (isSingular())
-        throw std::runtime_error("Singular matrix");
-
-    Matrix result = *this;
-    double mainDeterminant = result.determinant();
-
-    for (std::size_t i = 0; i < rowCnt_; ++i)
-    {
-        for (std::size_t j = 0; j < colCnt_; ++j)
-        {
-            int sign = (i + j) % 2 == 0 ? 1 : -1;
-            result.data_[j][i] = sign * this->submatrix(i, j).determinant() / mainDeterminant;
-        }
-    }
-
-    return result;
+    return LUDecomposition(*this).inverse();
 }
 
 auto Matrix::rowEchelonForm() const -> Matrix
@@ -876,7 +973,7 @@ auto Matrix::rowEchelonForm() const -> Matrix
     {
         for (std::size_t i = ordered; i < rowCnt_; ++i)
         {
-            if (result.data_[i][j] == 0) // locate pivot row by finding first non-zero element in a column
+            if (result.row(i)[j] == 0) // locate pivot row by finding first non-zero element in a column
                 continue;
 
             if (i != ordered) // move pivot row to the ordered part
@@ -886,8 +983,8 @@ auto Matrix::rowEchelonForm() const -> Matrix
 
             for (std::size_t i2 = ordered + 1; i2 < rowCnt_; ++i2) // set elements below first element in current pivot row to 0
             {
-                if (result.data_[i2][j] != 0)
-                    result.addRowToRow(ordered, i2, -result.data_[i2][j]);
+                if (result.row(i2)[j] != 0)
+                    result.addRowToRow(ordered, i2, -result.row(i2)[j]);
             }
 
             ++ordered;
@@ -909,18 +1006,18 @@ auto Matrix::reducedRowEchelonForm() const -> Matrix
     {
         for (std::size_t j = 0; j < colCnt_; ++j)
         {
-            if (result.data_[i][j] == 0)
+            if (result.row(i)[j] == 0)
                 continue;
 
-            if (result.data_[i][j] != 1) // set the pivot element in the pivot row to 1
+            if (result.row(i)[j] != 1) // set the pivot element in the pivot row to 1
             {
-                result.multiplyRow(i, 1.0 / result.data_[i][j]);
+                result.multiplyRow(i, 1.0 / result.row(i)[j]);
             }
 
             for (std::size_t i2 = 0; i2 < i; ++i2) // set the other elements in the pivot column to 0
             {
-                if (result.data_[i2][j] != 0)
-                    result.addRowToRow(i, i2, -result.data_[i2][j]);
+                if (result.row(i2)[j] != 0)
+                    result.addRowToRow(i, i2, -result.row(i2)[j]);
             }
 
             break;
@@ -932,18 +1029,10 @@ auto Matrix::reducedRowEchelonForm() const -> Matrix
 
 auto Matrix::rank() const -> std::size_t
 {
-    if (!isRowEchelonForm())
-        return this->rowEchelonForm().rank();
-
-    std::size_t nonZeroRows = 0;
-
-    for (std::size_t i = 0; i < rowCnt_; ++i)
-        nonZeroRows += !isRowZero(i);
-
-    return nonZeroRows;
+    return LUDecomposition(*this).rank();
 }
 
 auto Matrix::linSolve(const Matrix& a, const Matrix& b) -> Matrix
 {
-    return a.inverse() * b;
+    return LUDecomposition(a).solve(b);
 }
@@ -1,9 +1,16 @@
 #pragma once
 
+#include <algorithm>
 #include <initializer_list>
+#include <memory>
 #include <string>
+#include <type_traits>
+#include <utility>
 
-class Matrix
+#include "Gemm.hpp"
+#include "MatrixExpression.hpp"
+
+class Matrix : public MatrixExpression<Matrix>
 {
 public:
     Matrix() : Matrix(SIZE / 2, SIZE / 2) {}
@@ -15,23 +22,55 @@ public:
     Matrix& operator=(Matrix&& other) noexcept;
     ~Matrix();
 
+    template <typename E>
+    Matrix(const MatrixExpression<E>& expression);
+    template <typename E>
+    Matrix& operator=(const MatrixExpression<E>& expression);
+    template <typename L, typename R>
+    Matrix& operator=(const MatrixProduct<L, R>& product);
+
     friend void swap(Matrix& lhs, Matrix& rhs) noexcept;
     bool operator==(const Matrix& other) const;
     bool operator!=(const Matrix& other) const;
+    template <typename E>
+    bool operator==(const MatrixExpression<E>& other) const;
+    template <typename E>
+    bool operator!=(const MatrixExpression<E>& other) const { return !(*this == other); }
     auto operator[](std::size_t i) -> double*;
     auto operator[](std::size_t i) const -> const double*;
     auto print(bool debug = false) const -> std::string;
 
+    // Unchecked element access, used by the expressions
+    double operator()(std::size_t i, std::size_t j) const { return row(i)[j]; }
+    auto operator()(std::size_t i, std::size_t j) -> double& { return row(i)[j]; }
+
     // Scalar operations
     auto operator+=(double number) -> Matrix&;
     auto operator-=(double number) -> Matrix&;
     auto operator*=(double number) -> Matrix&;
     auto operator/=(double number) -> Matrix&;
 
-    // Matrix operations
-    auto operator+(const Matrix& other) const -> Matrix;
-    auto operator-(const Matrix& other) const -> Matrix;
-    auto operator*(const Matrix& other) const -> Matrix;
+    // Matrix operations (+, - and * build expressions, see MatrixExpression.hpp)
+    template <typename E>
+    auto operator+=(const MatrixExpression<E>& expression) -> Matrix&;
+    template <typename E>
+    auto operator-=(const MatrixExpression<E>& expression) -> Matrix&;
+
+    class NoAlias
+    {
+    public:
+        explicit NoAlias(Matrix& matrix) : matrix_(matrix) {}
+
+        template <typename E>
+        auto operator=(const MatrixExpression<E>& expression) -> Matrix&;
+
+    private:
+        Matrix& matrix_;
+    };
+
+    // Assignment without the protection against aliasing: a product is computed straight into
+    // this matrix (reusing its memory), so the matrix must not be an operand of the product.
+    auto noalias() -> NoAlias { return NoAlias(*this); }
 
     // Row operations
     auto getRowCnt() const -> std::size_t { return rowCnt_; }
@@ -83,6 +122,7 @@ public:
     void autofill(double element = 0);
     auto submatrix(std::size_t i, std::size_t j) const -> Matrix;
     auto transpose() const -> Matrix;
+    void transposeInPlace();
     double trace() const;
     double determinant() const;
     double sparsity() const;
@@ -93,19 +133,326 @@ public:
     static auto linSolve(const Matrix& a, const Matrix& b) -> Matrix;
 
 private:
+    friend class LUDecomposition;
+    template <typename L, typename R>
+    friend class MatrixProduct;
+
     static constexpr double EPSILON = 0.000001;
     static constexpr int SIZE = 10;
+    static constexpr std::size_t ALIGNMENT = 64;
+
+    double* data_ = nullptr;
 
-    double** data_ = nullptr;
+    struct Uninitialized {};
 
     std::size_t rowCnt_ = 0;
     std::size_t colCnt_ = 0;
     std::size_t rowDim_ = 0;
     std::size_t colDim_ = 0;
 
+    Matrix(std::size_t rowCnt, std::size_t colCnt, Uninitialized);
+
     bool isSameElement(double a, double b) const;
+    auto row(std::size_t i) -> double* { return data_ + i * colDim_; }
+    auto row(std::size_t i) const -> const double* { return data_ + i * colDim_; }
     auto updateSize(std::size_t s) const -> std::size_t;
+    auto updateColSize(std::size_t s) const -> std::size_t;
+    static auto allocate(std::size_t rowDim, std::size_t colDim) -> double*;
     void alloc();
     void resize();
     void cleanup();
 };
+
+template <typename E>
+Matrix::Matrix(const MatrixExpression<E>& expression) :
+    Matrix(expression.getRowCnt(), expression.getColCnt(), Uninitialized{})
+{
+    expression.self().evaluateTo(*this);
+}
+
+// Element-wise expressions are safe to evaluate in place, even if they read this matrix.
+template <typename E>
+Matrix& Matrix::operator=(const MatrixExpression<E>& expression)
+{
+    if (rowCnt_ == expression.getRowCnt() && colCnt_ == expression.getColCnt())
+    {
+        expression.self().evaluateTo(*this);
+        return *this;
+    }
+
+    Matrix result(expression);
+    swap(*this, result);
+    return *this;
+}
+
+// A product may read this matrix while it is being written, so it goes to a new one.
+template <typename L, typename R>
+Matrix& Matrix::operator=(const MatrixProduct<L, R>& product)
+{
+    Matrix result(product);
+    swap(*this, result);
+    return *this;
+}
+
+template <typename E>
+bool Matrix::operator==(const MatrixExpression<E>& other) const
+{
+    if (rowCnt_ != other.getRowCnt() || colCnt_ != other.getColCnt())
+        return false;
+
+    const auto& expression = other.self();
+
+    for (std::size_t i = 0; i < rowCnt_; ++i)
+    {
+        for (std::size_t j = 0; j < colCnt_; ++j)
+        {
+            if (!isSameElement(row(i)[j], expression(i, j)))
+                return false;
+        }
+    }
+    return true;
+}
+
+template <typename E, typename = std::enable_if_t<!std::is_same_v<E, Matrix>>>
+bool operator==(const MatrixExpression<E>& lhs, const Matrix& rhs)
+{
+    return rhs == lhs;
+}
+
+template <typename E, typename = std::enable_if_t<!std::is_same_v<E, Matrix>>>
+bool operator!=(const MatrixExpression<E>& lhs, const Matrix& rhs)
+{
+    return rhs != lhs;
+}
+
+template <typename E>
+auto Matrix::operator+=(const MatrixExpression<E>& expression) -> Matrix&
+{
+    return *this = *this + expression.self();
+}
+
+template <typename E>
+auto Matrix::operator-=(const MatrixExpression<E>& expression) -> Matrix&
+{
+    return *this = *this - expression.self();
+}
+
+template <typename E>
+auto Matrix::NoAlias::operator=(const MatrixExpression<E>& expression) -> Matrix&
+{
+    if (matrix_.rowCnt_ != expression.getRowCnt() || matrix_.colCnt_ != expression.getColCnt())
+        matrix_ = Matrix(expression.getRowCnt(), expression.getColCnt());
+
+    expression.self().evaluateTo(matrix_);
+    return matrix_;
+}
+
+// Matrix product. It can't be computed element by element, so it is done by gemm: straight into
+// the destination when assigned, or into a cached matrix the first time an element is read when
+// it is part of a larger expression.
+template <typename L, typename R>
+class MatrixProduct : public MatrixExpression<MatrixProduct<L, R>>
+{
+public:
+    MatrixProduct(L lhs, R rhs) : lhs_(std::move(lhs)), rhs_(std::move(rhs))
+    {
+        if (lhs_.getColCnt() != rhs_.getRowCnt())
+            throw std::runtime_error("Invalid dimensions");
+    }
+
+    auto getRowCnt() const -> std::size_t { return lhs_.getRowCnt(); }
+    auto getColCnt() const -> std::size_t { return rhs_.getColCnt(); }
+    double operator()(std::size_t i, std::size_t j) const { return value()(i, j); }
+
+    // Dest must have the dimensions of the product and must not be one of its operands.
+    template <typename Dest>
+    void evaluateTo(Dest& dest) const;
+
+private:
+    L lhs_;
+    R rhs_;
+    mutable std::shared_ptr<const Matrix> value_;
+
+    auto value() const -> const Matrix&;
+
+    // Matrices are used in place, other operands are evaluated first.
+    template <typename E>
+    static auto evaluated(const E& expression) -> std::conditional_t<std::is_same_v<E, Matrix>, const Matrix&, Matrix>
+    {
+        return expression;
+    }
+};
+
+// Other destinations (FixedMatrix) get the elements of the cached product.
+template <typename L, typename R>
+template <typename Dest>
+void MatrixProduct<L, R>::evaluateTo(Dest& dest) const
+{
+    if constexpr (!std::is_same_v<Dest, Matrix>)
+    {
+        value().evaluateTo(dest);
+    }
+    else
+    {
+        const auto& lhs = evaluated(lhs_);
+        const auto& rhs = evaluated(rhs_);
+
+        for (std::size_t i = 0; i < dest.rowCnt_; ++i)
+            std::fill(dest.row(i), dest.row(i) + dest.colCnt_, 0.0);
+
+        gemm(lhs.rowCnt_, rhs.colCnt_, lhs.colCnt_, 1, lhs.data_, lhs.colDim_, rhs.data_, rhs.colDim_, dest.data_, dest.colDim_);
+    }
+}
+
+template <typename L, typename R>
+auto MatrixProduct<L, R>::value() const -> const Matrix&
+{
+    if (value_ == nullptr)
+        value_ = std::make_shared<const Matrix>(*this);
+
+    return *value_;
+}
+
+template <typename L, typename R, typename = std::enable_if_t<isExpressionOperands<L, R>>>
+auto operator*(L&& lhs, R&& rhs) -> MatrixProduct<ExpressionOperandType<L>, ExpressionOperandType<R>>
+{
+    return { std::forward<L>(lhs), std::forward<R>(rhs) };
+}
+
+template <typename E>
+auto MatrixExpression<E>::eval() const -> Matrix
+{
+    return Matrix(*this);
+}
+
+template <typename E>
+auto MatrixExpression<E>::print(bool debug) const -> std::string
+{
+    return eval().print(debug);
+}
+
+template <typename E>
+bool MatrixExpression<E>::isZero() const
+{
+    return eval().isZero();
+}
+
+template <typename E>
+bool MatrixExpression<E>::isSquare() const
+{
+    return eval().isSquare();
+}
+
+template <typename E>
+bool MatrixExpression<E>::isDiagonal() const
+{
+    return eval().isDiagonal();
+}
+
+template <typename E>
+bool MatrixExpression<E>::isIdentity() const
+{
+    return eval().isIdentity();
+}
+
+template <typename E>
+bool MatrixExpression<E>::isSymmetrical() const
+{
+    return eval().isSymmetrical();
+}
+
+template <typename E>
+bool MatrixExpression<E>::isLowerTriangular() const
+{
+    return eval().isLowerTriangular();
+}
+
+template <typename E>
+bool MatrixExpression<E>::isUpperTriangular() const
+{
+    return eval().isUpperTriangular();
+}
+
+template <typename E>
+bool MatrixExpression<E>::isTriangular() const
+{
+    return eval().isTriangular();
+}
+
+template <typename E>
+bool MatrixExpression<E>::isSingular() const
+{
+    return eval().isSingular();
+}
+
+template <typename E>
+bool MatrixExpression<E>::isSparse() const
+{
+    return eval().isSparse();
+}
+
+template <typename E>
+bool MatrixExpression<E>::isRowEchelonForm() const
+{
+    return eval().isRowEchelonForm();
+}
+
+template <typename E>
+bool MatrixExpression<E>::isReducedRowEchelonForm() const
+{
+    return eval().isReducedRowEchelonForm();
+}
+
+template <typename E>
+auto MatrixExpression<E>::submatrix(std::size_t i, std::size_t j) const -> Matrix
+{
+    return eval().submatrix(i, j);
+}
+
+template <typename E>
+auto MatrixExpression<E>::transpose() const -> Matrix
+{
+    return eval().transpose();
+}
+
+template <typename E>
+double MatrixExpression<E>::trace() const
+{
+    return eval().trace();
+}
+
+template <typename E>
+double MatrixExpression<E>::determinant() const
+{
+    return eval().determinant();
+}
+
+template <typename E>
+double MatrixExpression<E>::sparsity() const
+{
+    return eval().sparsity();
+}
+
+template <typename E>
+auto MatrixExpression<E>::inverse() const -> Matrix
+{
+    return eval().inverse();
+}
+
+template <typename E>
+auto MatrixExpression<E>::rowEchelonForm() const -> Matrix
+{
+    return eval().rowEchelonForm();
+}
+
+template <typename E>
+auto MatrixExpression<E>::reducedRowEchelonForm() const -> Matrix
+{
+    return eval().reducedRowEchelonForm();
+}
+
+template <typename E>
+auto MatrixExpression<E>::rank() const -> std::size_t
+{
+    return eval().rank();
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+class Matrix;
+
+template <typename L, typename R>
+class MatrixProduct;
+
+// Base of all matrix expressions (CRTP). Arithmetic on matrices builds a tree of lightweight nodes
+// instead of computing anything, and the whole tree is evaluated in a single loop when it is
+// assigned to a Matrix, so a + b - c * 2 needs no intermediate matrices. Expressions keep
+// references to the named matrices they use, so they must not outlive them. Temporary matrices
+// are moved into the expression.
+template <typename E>
+class MatrixExpression
+{
+public:
+    auto self() const -> const E& { return static_cast<const E&>(*this); }
+    auto getRowCnt() const -> std::size_t { return self().getRowCnt(); }
+    auto getColCnt() const -> std::size_t { return self().getColCnt(); }
+    double operator()(std::size_t i, std::size_t j) const { return self()(i, j); }
+
+    // Write the elements into dest of the same dimensions. Each element only reads the same
+    // position of its operands, so dest may be one of them.
+    template <typename Dest>
+    void evaluateTo(Dest& dest) const;
+
+    // The Matrix API on an expression works on its evaluated copy, so (a * b).determinant() works
+    // as it did when the operators returned matrices (defined in Matrix.hpp).
+    auto eval() const -> Matrix;
+    auto print(bool debug = false) const -> std::string;
+    bool isZero() const;
+    bool isSquare() const;
+    bool isDiagonal() const;
+    bool isIdentity() const;
+    bool isSymmetrical() const;
+    bool isLowerTriangular() const;
+    bool isUpperTriangular() const;
+    bool isTriangular() const;
+    bool isSingular() const;
+    bool isSparse() const;
+    bool isRowEchelonForm() const;
+    bool isReducedRowEchelonForm() const;
+    auto submatrix(std::size_t i, std::size_t j) const -> Matrix;
+    auto transpose() const -> Matrix;
+    double trace() const;
+    double determinant() const;
+    double sparsity() const;
+    auto inverse() const -> Matrix;
+    auto rowEchelonForm() const -> Matrix;
+    auto reducedRowEchelonForm() const -> Matrix;
+    auto rank() const -> std::size_t;
+};
+
+template <typename E>
+template <typename Dest>
+void MatrixExpression<E>::evaluateTo(Dest& dest) const
+{
+    const auto& expression = self();
+    const auto rowCnt = expression.getRowCnt();
+    const auto colCnt = expression.getColCnt();
+
+    for (std::size_t i = 0; i < rowCnt; ++i)
+    {
+        for (std::size_t j = 0; j < colCnt; ++j)
+            dest(i, j) = expression(i, j);
+    }
+}
+
+// Named matrices are held by reference. Expression nodes and temporary matrices are held by value
+// (the temporaries are moved in), so a node kept in an auto variable never refers to a destroyed
+// temporary. Types with their own arithmetic (FixedMatrix) are left to it when all operands have it.
+template <typename E>
+struct ExpressionTraits
+{
+    static constexpr bool byReference = false;
+    static constexpr bool ownArithmetic = false;
+};
+
+template <>
+struct ExpressionTraits<Matrix>
+{
+    static constexpr bool byReference = true;
+    static constexpr bool ownArithmetic = false;
+};
+
+// Operand stored by a node built from an argument of type T (as deduced by a forwarding reference).
+template <typename T>
+using ExpressionOperandType = std::conditional_t<std::is_lvalue_reference_v<T> && ExpressionTraits<std::decay_t<T>>::byReference,
+    const std::decay_t<T>&, std::decay_t<T>>;
+
+template <typename T>
+constexpr bool isMatrixExpression = std::is_base_of_v<MatrixExpression<std::decay_t<T>>, std::decay_t<T>>;
+
+template <typename T>
+constexpr bool isExpressionOperand = isMatrixExpression<T> && !ExpressionTraits<std::decay_t<T>>::ownArithmetic;
+
+template <typename L, typename R>
+constexpr bool isExpressionOperands = isMatrixExpression<L> && isMatrixExpression<R> &&
+    (isExpressionOperand<L> || isExpressionOperand<R>);
+
+template <typename L, typename R, typename Op>
+class MatrixBinaryExpression : public MatrixExpression<MatrixBinaryExpression<L, R, Op>>
+{
+public:
+    MatrixBinaryExpression(L lhs, R rhs) : lhs_(std::move(lhs)), rhs_(std::move(rhs))
+    {
+        if (lhs_.getRowCnt() != rhs_.getRowCnt() || lhs_.getColCnt() != rhs_.getColCnt())
+            throw std::runtime_error("Invalid dimensions");
+    }
+
+    auto getRowCnt() const -> std::size_t { return lhs_.getRowCnt(); }
+    auto getColCnt() const -> std::size_t { return lhs_.getColCnt(); }
+    double operator()(std::size_t i, std::size_t j) const { return Op()(lhs_(i, j), rhs_(i, j)); }
+
+private:
+    L lhs_;
+    R rhs_;
+};
+
+template <typename E, typename Op>
+class MatrixScalarExpression : public MatrixExpression<MatrixScalarExpression<E, Op>>
+{
+public:
+    MatrixScalarExpression(E expression, double number) : expression_(std::move(expression)), number_(number) {}
+
+    auto getRowCnt() const -> std::size_t { return expression_.getRowCnt(); }
+    auto getColCnt() const -> std::size_t { return expression_.getColCnt(); }
+    double operator()(std::size_t i, std::size_t j) const { return Op()(expression_(i, j), number_); }
+
+private:
+    E expression_;
+    double number_;
+};
+
+template <typename E, typename Op>
+class MatrixUnaryExpression : public MatrixExpression<MatrixUnaryExpression<E, Op>>
+{
+public:
+    explicit MatrixUnaryExpression(E expression) : expression_(std::move(expression)) {}
+
+    auto getRowCnt() const -> std::size_t { return expression_.getRowCnt(); }
+    auto getColCnt() const -> std::size_t { return expression_.getColCnt(); }
+    double operator()(std::size_t i, std::size_t j) const { return Op()(expression_(i, j)); }
+
+private:
+    E expression_;
+};
+
+template <typename L, typename R, typename = std::enable_if_t<isExpressionOperands<L, R>>>
+auto operator+(L&& lhs, R&& rhs) -> MatrixBinaryExpression<ExpressionOperandType<L>, ExpressionOperandType<R>, std::plus<>>
+{
+    return { std::forward<L>(lhs), std::forward<R>(rhs) };
+}
+
+template <typename L, typename R, typename = std::enable_if_t<isExpressionOperands<L, R>>>
+auto operator-(L&& lhs, R&& rhs) -> MatrixBinaryExpression<ExpressionOperandType<L>, ExpressionOperandType<R>, std::minus<>>
+{
+    return { std::forward<L>(lhs), std::forward<R>(rhs) };
+}
+
+template <typename E, typename = std::enable_if_t<isExpressionOperand<E>>>
+auto operator-(E&& expression) -> MatrixUnaryExpression<ExpressionOperandType<E>, std::negate<>>
+{
+    return MatrixUnaryExpression<ExpressionOperandType<E>, std::negate<>>(std::forward<E>(expression));
+}
+
+template <typename E, typename = std::enable_if_t<isExpressionOperand<E>>>
+auto operator+(E&& expression, double number) -> MatrixScalarExpression<ExpressionOperandType<E>, std::plus<>>
+{
+    return { std::forward<E>(expression), number };
+}
+
+template <typename E, typename = std::enable_if_t<isExpressionOperand<E>>>
+auto operator-(E&& expression, double number) -> MatrixScalarExpression<ExpressionOperandType<E>, std::minus<>>
+{
+    return { std::forward<E>(expression), number };
+}
+
+template <typename E, typename = std::enable_if_t<isExpressionOperand<E>>>
+auto operator*(E&& expression, double number) -> MatrixScalarExpression<ExpressionOperandType<E>, std::multiplies<>>
+{
+    return { std::forward<E>(expression), number };
+}
+
+template <typename E, typename = std::enable_if_t<isExpressionOperand<E>>>
+auto operator*(double number, E&& expression) -> MatrixScalarExpression<ExpressionOperandType<E>, std::multiplies<>>
+{
+    return { std::forward<E>(expression), number };
+}
+
+template <typename E, typename = std::enable_if_t<isExpressionOperand<E>>>
+auto operator/(E&& expression, double number) -> MatrixScalarExpression<ExpressionOperandType<E>, std::divides<>>
+{
+    return { std::forward<E>(expression), number };
+}
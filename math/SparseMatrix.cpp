@@ -0,0 +1,416 @@
+#include "SparseMatrix.hpp"
+
+#include <algorithm>
+#include <future>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace
+{
+// Minimum number of stored elements processed per thread.
+constexpr std::size_t PARALLEL_WORK = 1 << 16;
+
+// Widest right-hand side of a product gathered in a dense accumulator, which takes 16 bytes per
+// column in every thread (16 MB here). Wider ones are accumulated by sorting the row products.
+constexpr std::size_t DENSE_ACCUMULATOR_COLS = 1 << 20;
+
+// Run task(part) for every part, the first one on the calling thread.
+template <typename Task>
+void runParts(std::size_t parts, Task task)
+{
+    std::vector<std::future<void>> tasks;
+
+    for (std::size_t part = 1; part < parts; ++part)
+        tasks.push_back(std::async(std::launch::async, task, part));
+
+    task(0);
+
+    for (auto& future : tasks)
+        future.get();
+}
+
+} // namespace
+
+SparseMatrix::SparseMatrix(std::size_t rowCnt, std::size_t colCnt, Format format) :
+    rowCnt_(rowCnt),
+    colCnt_(colCnt),
+    format_(format),
+    offsets_(majorCnt() + 1, 0)
+{}
+
+// The entries are distributed to their lines by a counting sort, then every line is sorted and
+// duplicate entries are summed.
+SparseMatrix::SparseMatrix(std::size_t rowCnt, std::size_t colCnt, std::vector<Entry> entries, Format format) :
+    SparseMatrix(rowCnt, colCnt, format)
+{
+    const bool csr = format_ == Format::Csr;
+
+    for (const auto& [i, j, value] : entries)
+    {
+        if (i >= rowCnt_ || j >= colCnt_)
+            throw std::runtime_error("Index out of range");
+
+        ++offsets_[(csr ? i : j) + 1];
+    }
+
+    std::partial_sum(offsets_.begin(), offsets_.end(), offsets_.begin());
+    indices_.resize(entries.size());
+    values_.resize(entries.size());
+
+    auto next = offsets_;
+    for (const auto& [i, j, value] : entries)
+    {
+        const auto pos = next[csr ? i : j]++;
+        indices_[pos] = csr ? j : i;
+        values_[pos] = value;
+    }
+
+    std::vector<std::pair<std::size_t, double>> line;
+    std::size_t size = 0;
+
+    for (std::size_t k = 0; k < majorCnt(); ++k)
+    {
+        line.clear();
+        for (auto p = offsets_[k]; p < offsets_[k + 1]; ++p)
+            line.emplace_back(indices_[p], values_[p]);
+
+        std::sort(line.begin(), line.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+        offsets_[k] = size;
+
+        for (std::size_t p = 0; p < line.size(); ++p)
+        {
+            if (p > 0 && line[p].first == line[p - 1].first)
+            {
+                values_[size - 1] += line[p].second;
+                continue;
+            }
+
+            indices_[size] = line[p].first;
+            values_[size] = line[p].second;
+            ++size;
+        }
+    }
+
+    offsets_[majorCnt()] = size;
+    indices_.resize(size);
+    values_.resize(size);
+}
+
+SparseMatrix::SparseMatrix(const Matrix& matrix, Format format) :
+    SparseMatrix(matrix.getRowCnt(), matrix.getColCnt())
+{
+    for (std::size_t i = 0; i < rowCnt_; ++i)
+    {
+        for (std::size_t j = 0; j < colCnt_; ++j)
+        {
+            if (matrix(i, j) != 0)
+            {
+                indices_.push_back(j);
+                values_.push_back(matrix(i, j));
+            }
+        }
+
+        offsets_[i + 1] = values_.size();
+    }
+
+    if (format == Format::Csc)
+        *this = toFormat(format);
+}
+
+double SparseMatrix::sparsity() const
+{
+    std::size_t totalElements = rowCnt_ * colCnt_;
+    return static_cast<double>(totalElements - nonZeroCnt()) / totalElements;
+}
+
+double SparseMatrix::at(std::size_t i, std::size_t j) const
+{
+    if (i >= rowCnt_ || j >= colCnt_)
+        throw std::runtime_error("Index out of range");
+
+    const auto major = format_ == Format::Csr ? i : j;
+    const auto minor = format_ == Format::Csr ? j : i;
+    const auto first = indices_.begin() + offsets_[major];
+    const auto last = indices_.begin() + offsets_[major + 1];
+    const auto it = std::lower_bound(first, last, minor);
+
+    return it != last && *it == minor ? values_[it - indices_.begin()] : 0;
+}
+
+// One "row column value" line per stored element.
+auto SparseMatrix::print() const -> std::string
+{
+    std::stringstream out;
+
+    for (std::size_t k = 0; k < majorCnt(); ++k)
+    {
+        for (auto p = offsets_[k]; p < offsets_[k + 1]; ++p)
+        {
+            if (format_ == Format::Csr)
+                out << k << " " << indices_[p] << " " << values_[p] << "\n";
+            else
+                out << indices_[p] << " " << k << " " << values_[p] << "\n";
+        }
+    }
+
+    return out.str();
+}
+
+auto SparseMatrix::toMatrix() const -> Matrix
+{
+    Matrix result(rowCnt_, colCnt_);
+
+    for (std::size_t k = 0; k < majorCnt(); ++k)
+    {
+        for (auto p = offsets_[k]; p < offsets_[k + 1]; ++p)
+        {
+            if (format_ == Format::Csr)
+                result(k, indices_[p]) = values_[p];
+            else
+                result(indices_[p], k) = values_[p];
+        }
+    }
+
+    return result;
+}
+
+// Counting sort by the minor index. Lines are visited in order, so the new lines come out sorted.
+auto SparseMatrix::toFormat(Format format) const -> SparseMatrix
+{
+    if (format == format_)
+        return *this;
+
+    SparseMatrix result(rowCnt_, colCnt_, format);
+    result.indices_.resize(nonZeroCnt());
+    result.values_.resize(nonZeroCnt());
+
+    for (auto index : indices_)
+        ++result.offsets_[index + 1];
+
+    std::partial_sum(result.offsets_.begin(), result.offsets_.end(), result.offsets_.begin());
+    auto next = result.offsets_;
+
+    for (std::size_t k = 0; k < majorCnt(); ++k)
+    {
+        for (auto p = offsets_[k]; p < offsets_[k + 1]; ++p)
+        {
+            const auto pos = next[indices_[p]]++;
+            result.indices_[pos] = k;
+            result.values_[pos] = values_[p];
+        }
+    }
+
+    return result;
+}
+
+auto SparseMatrix::transpose() const -> SparseMatrix
+{
+    SparseMatrix result = *this;
+    std::swap(result.rowCnt_, result.colCnt_);
+    result.format_ = format_ == Format::Csr ? Format::Csc : Format::Csr;
+    return result;
+}
+
+auto SparseMatrix::threadCnt(std::size_t work, std::size_t threads) -> std::size_t
+{
+    return std::min(std::max<std::size_t>(threads, 1), work / PARALLEL_WORK + 1);
+}
+
+// Boundaries of parts of consecutive lines holding about the same number of stored elements.
+auto SparseMatrix::splitLines(std::size_t parts) const -> std::vector<std::size_t>
+{
+    std::vector<std::size_t> bounds(parts + 1, majorCnt());
+    bounds[0] = 0;
+
+    for (std::size_t part = 1; part < parts; ++part)
+    {
+        const auto target = nonZeroCnt() * part / parts;
+        bounds[part] = std::lower_bound(offsets_.begin(), offsets_.end() - 1, target) - offsets_.begin();
+    }
+
+    return bounds;
+}
+
+auto SparseMatrix::operator*(const std::vector<double>& vector) const -> std::vector<double>
+{
+    return multiply(vector, std::thread::hardware_concurrency());
+}
+
+auto SparseMatrix::operator*(const SparseMatrix& other) const -> SparseMatrix
+{
+    return multiply(other, std::thread::hardware_concurrency());
+}
+
+// In CSR every row is an independent dot product, rows are split between threads. In CSC every
+// column scatters into the whole result, so every thread sums its columns into a vector of its own
+// and the vectors are then added by ranges of rows. The extra vectors pay off only when a thread
+// has more elements than there are rows, which also keeps their memory below that of the matrix.
+auto SparseMatrix::multiply(const std::vector<double>& vector, std::size_t threads) const -> std::vector<double>
+{
+    if (vector.size() != colCnt_)
+        throw std::runtime_error("Invalid dimensions");
+
+    std::vector<double> result(rowCnt_, 0);
+
+    if (format_ == Format::Csc)
+    {
+        const auto parts = std::min(threadCnt(nonZeroCnt(), threads), nonZeroCnt() / std::max<std::size_t>(rowCnt_, 1) + 1);
+        const auto bounds = splitLines(parts);
+        std::vector<std::vector<double>> partials(parts - 1, std::vector<double>(rowCnt_, 0));
+
+        runParts(parts, [&](std::size_t part) {
+            auto& sums = part == 0 ? result : partials[part - 1];
+
+            for (auto j = bounds[part]; j < bounds[part + 1]; ++j)
+            {
+                for (auto p = offsets_[j]; p < offsets_[j + 1]; ++p)
+                    sums[indices_[p]] += values_[p] * vector[j];
+            }
+        });
+
+        if (parts > 1)
+        {
+            runParts(parts, [&](std::size_t part) {
+                for (auto i = rowCnt_ * part / parts; i < rowCnt_ * (part + 1) / parts; ++i)
+                {
+                    for (const auto& sums : partials)
+                        result[i] += sums[i];
+                }
+            });
+        }
+
+        return result;
+    }
+
+    const auto parts = threadCnt(nonZeroCnt(), threads);
+    const auto bounds = splitLines(parts);
+
+    runParts(parts, [&](std::size_t part) {
+        for (auto i = bounds[part]; i < bounds[part + 1]; ++i)
+        {
+            double sum = 0;
+            for (auto p = offsets_[i]; p < offsets_[i + 1]; ++p)
+                sum += values_[p] * vector[indices_[p]];
+            result[i] = sum;
+        }
+    });
+
+    return result;
+}
+
+// Gustavson's algorithm on CSR operands: row i of the product is the sum of the rows k of other
+// scaled by the elements (i, k) of this matrix. The sum is gathered in a dense accumulator, with
+// a marker per column telling which row last touched it, so clearing it costs nothing. The dense
+// arrays are as wide as other, so for very wide matrices the scaled elements of a row are instead
+// collected, stable sorted by column and summed, which needs memory only for the row itself.
+// Rows are split between threads, each producing its own part of the result.
+auto SparseMatrix::multiply(const SparseMatrix& other, std::size_t threads) const -> SparseMatrix
+{
+    if (colCnt_ != other.rowCnt_)
+        throw std::runtime_error("Invalid dimensions");
+
+    const auto lhs = toFormat(Format::Csr);
+    const auto rhs = other.toFormat(Format::Csr);
+    const bool dense = rhs.colCnt_ <= DENSE_ACCUMULATOR_COLS;
+
+    struct Part
+    {
+        std::vector<std::size_t> rowSizes;
+        std::vector<std::size_t> indices;
+        std::vector<double> values;
+    };
+
+    const auto parts = threadCnt(lhs.nonZeroCnt(), threads);
+    const auto bounds = lhs.splitLines(parts);
+    std::vector<Part> results(parts);
+
+    runParts(parts, [&](std::size_t part) {
+        auto& result = results[part];
+        std::vector<double> accumulator(dense ? rhs.colCnt_ : 0);
+        std::vector<std::size_t> marker(dense ? rhs.colCnt_ : 0, std::numeric_limits<std::size_t>::max());
+        std::vector<std::size_t> touched;
+        std::vector<std::pair<std::size_t, double>> products;
+
+        for (auto i = bounds[part]; i < bounds[part + 1]; ++i)
+        {
+            touched.clear();
+            products.clear();
+
+            for (auto p = lhs.offsets_[i]; p < lhs.offsets_[i + 1]; ++p)
+            {
+                const auto k = lhs.indices_[p];
+                const auto scale = lhs.values_[p];
+
+                for (auto q = rhs.offsets_[k]; q < rhs.offsets_[k + 1]; ++q)
+                {
+                    const auto j = rhs.indices_[q];
+
+                    if (!dense)
+                    {
+                        products.emplace_back(j, scale * rhs.values_[q]);
+                        continue;
+                    }
+
+                    if (marker[j] != i)
+                    {
+                        marker[j] = i;
+                        accumulator[j] = 0;
+                        touched.push_back(j);
+                    }
+
+                    accumulator[j] += scale * rhs.values_[q];
+                }
+            }
+
+            const auto rowStart = result.indices.size();
+
+            if (dense)
+            {
+                std::sort(touched.begin(), touched.end());
+                for (auto j : touched)
+                {
+                    result.indices.push_back(j);
+                    result.values.push_back(accumulator[j]);
+                }
+            }
+            else
+            {
+                std::stable_sort(products.begin(), products.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+                for (std::size_t p = 0; p < products.size(); ++p)
+                {
+                    if (p > 0 && products[p].first == products[p - 1].first)
+                    {
+                        result.values.back() += products[p].second;
+                        continue;
+                    }
+
+                    result.indices.push_back(products[p].first);
+                    result.values.push_back(products[p].second);
+                }
+            }
+
+            result.rowSizes.push_back(result.indices.size() - rowStart);
+        }
+    });
+
+    SparseMatrix product(rowCnt_, other.colCnt_);
+    std::size_t i = 0;
+
+    for (auto& result : results)
+    {
+        for (auto size : result.rowSizes)
+        {
+            product.offsets_[i + 1] = product.offsets_[i] + size;
+            ++i;
+        }
+
+        product.indices_.insert(product.indices_.end(), result.indices.begin(), result.indices.end());
+        product.values_.insert(product.values_.end(), result.values.begin(), result.values.end());
+    }
+
+    return product;
+}
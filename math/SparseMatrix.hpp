@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "Matrix.hpp"
+
+// Sparse matrix in compressed row (CSR) or compressed column (CSC) format. Only non-zero elements
+// are stored: the elements of every major line (row in CSR, column in CSC) are kept together,
+// sorted by their minor index, and offsets_[k] is where line k starts. CSR of a matrix has the
+// same arrays as CSC of its transpose, which makes transposing free.
+class SparseMatrix
+{
+public:
+    enum class Format
+    {
+        Csr,
+        Csc
+    };
+
+    using Entry = std::tuple<std::size_t, std::size_t, double>; // row, column, value
+
+    SparseMatrix(std::size_t rowCnt, std::size_t colCnt, Format format = Format::Csr);
+    SparseMatrix(std::size_t rowCnt, std::size_t colCnt, std::vector<Entry> entries, Format format = Format::Csr);
+    explicit SparseMatrix(const Matrix& matrix, Format format = Format::Csr);
+
+    auto getRowCnt() const -> std::size_t { return rowCnt_; }
+    auto getColCnt() const -> std::size_t { return colCnt_; }
+    auto getFormat() const -> Format { return format_; }
+    auto nonZeroCnt() const -> std::size_t { return values_.size(); }
+    double sparsity() const;
+    double at(std::size_t i, std::size_t j) const;
+    auto print() const -> std::string;
+
+    auto toMatrix() const -> Matrix;
+    auto toFormat(Format format) const -> SparseMatrix;
+    auto transpose() const -> SparseMatrix;
+
+    auto operator*(const std::vector<double>& vector) const -> std::vector<double>;
+    auto operator*(const SparseMatrix& other) const -> SparseMatrix;
+
+    // Products using at most the given number of threads (the operators use one per core).
+    auto multiply(const std::vector<double>& vector, std::size_t threads) const -> std::vector<double>;
+    auto multiply(const SparseMatrix& other, std::size_t threads) const -> SparseMatrix;
+
+private:
+    std::size_t rowCnt_ = 0;
+    std::size_t colCnt_ = 0;
+    Format format_ = Format::Csr;
+
+    std::vector<std::size_t> offsets_;
+    std::vector<std::size_t> indices_;
+    std::vector<double> values_;
+
+    auto majorCnt() const -> std::size_t { return format_ == Format::Csr ? rowCnt_ : colCnt_; }
+    auto minorCnt() const -> std::size_t { return format_ == Format::Csr ? colCnt_ : rowCnt_; }
+    auto splitLines(std::size_t parts) const -> std::vector<std::size_t>;
+    static auto threadCnt(std::size_t work, std::size_t threads) -> std::size_t;
+};
@@ -0,0 +1,433 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define EXTERNAL_SORT_MMAP 1
+#define EXTERNAL_SORT_POSIX 1
+#endif
+
+#include <sequence/Sorter.hpp>
+
+namespace sort
+{
+namespace detail
+{
+struct FileCloser
+{
+    void operator()(std::FILE* file) const { std::fclose(file); }
+};
+
+using TempFile = std::unique_ptr<std::FILE, FileCloser>;
+
+// Creates an anonymous file for a sorted run. The file is unlinked right after it is created, so it
+// is removed even when the sort throws. An empty directory uses the system temporary directory.
+inline auto createRunFile(const std::string& directory) -> TempFile
+{
+    if (directory.empty())
+        return TempFile(std::tmpfile());
+
+#ifdef EXTERNAL_SORT_POSIX
+    std::string path = directory + "/sort_run_XXXXXX";
+    const int fd = mkstemp(path.data());
+    if (fd < 0)
+        throw std::runtime_error("Cannot create run file in spill directory");
+
+    unlink(path.c_str());
+    TempFile file(fdopen(fd, "w+b"));
+    if (file == nullptr)
+    {
+        close(fd);
+        throw std::runtime_error("Cannot open run file in spill directory");
+    }
+
+    return file;
+#else
+    throw std::runtime_error("Spill directories are not supported on this platform");
+#endif
+}
+
+// Sequential reader of a sorted run spilled to a temporary file. The file is memory mapped where
+// available, otherwise it is read through a buffer of the given size.
+template <typename T>
+class RunReader
+{
+public:
+    RunReader(TempFile file, std::size_t size, std::size_t bufferSize);
+    RunReader(const RunReader<T>& other) = delete;
+    RunReader(RunReader<T>&& other) noexcept;
+    RunReader<T>& operator=(const RunReader<T>& other) = delete;
+    ~RunReader();
+
+    bool empty() const { return pos_ == end_; }
+    auto front() const -> const T& { return *pos_; }
+    void pop();
+
+private:
+    TempFile file_;
+    std::size_t remaining_ = 0; // elements not yet loaded into the buffer
+
+    const T* pos_ = nullptr;
+    const T* end_ = nullptr;
+
+    void* mapped_ = nullptr;
+    std::size_t mappedSize_ = 0;
+    std::vector<T> buffer_;
+
+    void refill();
+};
+
+template <typename T>
+RunReader<T>::RunReader(TempFile file, std::size_t size, std::size_t bufferSize) :
+    file_(std::move(file)),
+    remaining_(size)
+{
+#ifdef EXTERNAL_SORT_MMAP
+    if (size > 0)
+    {
+        mappedSize_ = size * sizeof(T);
+        mapped_ = mmap(nullptr, mappedSize_, PROT_READ, MAP_PRIVATE, fileno(file_.get()), 0);
+
+        if (mapped_ != MAP_FAILED)
+        {
+            madvise(mapped_, mappedSize_, MADV_SEQUENTIAL);
+            pos_ = static_cast<const T*>(mapped_);
+            end_ = pos_ + size;
+            remaining_ = 0;
+            return;
+        }
+
+        mapped_ = nullptr;
+        mappedSize_ = 0;
+    }
+#endif
+
+    std::rewind(file_.get());
+    buffer_.resize(std::max<std::size_t>(bufferSize, 1));
+    refill();
+}
+
+template <typename T>
+RunReader<T>::RunReader(RunReader<T>&& other) noexcept :
+    file_(std::move(other.file_)),
+    remaining_(other.remaining_),
+    pos_(other.pos_),
+    end_(other.end_),
+    mapped_(other.mapped_),
+    mappedSize_(other.mappedSize_),
+    buffer_(std::move(other.buffer_))
+{
+    other.mapped_ = nullptr;
+    other.pos_ = other.end_ = nullptr;
+}
+
+template <typename T>
+RunReader<T>::~RunReader()
+{
+#ifdef EXTERNAL_SORT_MMAP
+    if (mapped_ != nullptr)
+        munmap(mapped_, mappedSize_);
+#endif
+}
+
+template <typename T>
+void RunReader<T>::pop()
+{
+    if (++pos_ == end_ && remaining_ > 0)
+        refill();
+}
+
+template <typename T>
+void RunReader<T>::refill()
+{
+    const auto count = std::fread(buffer_.data(), sizeof(T), std::min(buffer_.size(), remaining_), file_.get());
+    if (count == 0 && remaining_ > 0)
+        throw std::runtime_error("Failed to read sorted run");
+
+    remaining_ -= count;
+    pos_ = buffer_.data();
+    end_ = pos_ + count;
+}
+
+// Loser tree over k runs: every inner node remembers the loser of the match played there and
+// the overall winner is kept at the root, so replacing the winner costs log2(k) comparisons
+// along a single leaf-to-root path. Exhausted runs lose every match, ties go to the lower run.
+template <typename T, typename Compare>
+class LoserTree
+{
+public:
+    LoserTree(std::vector<RunReader<T>>& runs, Compare cmp);
+
+    bool empty() const { return runs_[tree_[0]].empty(); }
+    auto top() const -> const T& { return runs_[tree_[0]].front(); }
+    void pop();
+
+private:
+    std::vector<RunReader<T>>& runs_;
+    std::vector<std::size_t> tree_;
+    Compare cmp_;
+
+    bool beats(std::size_t a, std::size_t b) const;
+};
+
+template <typename T, typename Compare>
+LoserTree<T, Compare>::LoserTree(std::vector<RunReader<T>>& runs, Compare cmp) :
+    runs_(runs),
+    tree_(std::max<std::size_t>(runs.size(), 1)),
+    cmp_(cmp)
+{
+    const auto k = runs_.size();
+    std::vector<std::size_t> winners(2 * k);
+
+    for (std::size_t i = 0; i < k; ++i)
+        winners[k + i] = i;
+
+    for (std::size_t node = k - 1; node > 0; --node)
+    {
+        const auto a = winners[2 * node];
+        const auto b = winners[2 * node + 1];
+        winners[node] = beats(a, b) ? a : b;
+        tree_[node] = beats(a, b) ? b : a;
+    }
+
+    tree_[0] = k > 1 ? winners[1] : 0;
+}
+
+template <typename T, typename Compare>
+void LoserTree<T, Compare>::pop()
+{
+    auto winner = tree_[0];
+    runs_[winner].pop();
+
+    for (auto node = (winner + runs_.size()) / 2; node > 0; node /= 2)
+    {
+        if (beats(tree_[node], winner))
+            std::swap(tree_[node], winner);
+    }
+
+    tree_[0] = winner;
+}
+
+template <typename T, typename Compare>
+bool LoserTree<T, Compare>::beats(std::size_t a, std::size_t b) const
+{
+    if (runs_[a].empty())
+        return false;
+    if (runs_[b].empty())
+        return true;
+
+    const auto& lhs = runs_[a].front();
+    const auto& rhs = runs_[b].front();
+    return cmp_(lhs, rhs) || (!cmp_(rhs, lhs) && a < b);
+}
+
+// Collects sorted runs of at most memoryBudget bytes in files in the spill directory and merges them.
+template <typename T, typename Compare>
+class ExternalSorter
+{
+public:
+    ExternalSorter(std::size_t memoryBudget, Compare cmp, std::string spillDirectory);
+
+    auto runCapacity() const -> std::size_t { return runCapacity_; }
+    void addRun(std::vector<T>& run);
+
+    template <typename Sink>
+    void merge(Sink sink);
+
+private:
+    // Upper bound on the number of runs merged at once.
+    static constexpr std::size_t MAX_FAN_IN = 64;
+    // Smallest read buffer a run gets during a merge, in bytes.
+    static constexpr std::size_t MIN_BUFFER_BYTES = 4096;
+
+    std::size_t runCapacity_;
+    Compare cmp_;
+    std::string spillDirectory_;
+
+    std::vector<std::pair<TempFile, std::size_t>> runs_;
+
+    auto fanIn() const -> std::size_t;
+
+    template <typename Sink>
+    void mergeRuns(std::size_t first, std::size_t last, Sink sink);
+};
+
+template <typename T, typename Compare>
+ExternalSorter<T, Compare>::ExternalSorter(std::size_t memoryBudget, Compare cmp, std::string spillDirectory) :
+    runCapacity_(std::max<std::size_t>(memoryBudget / sizeof(T), 1)),
+    cmp_(cmp),
+    spillDirectory_(std::move(spillDirectory))
+{}
+
+template <typename T, typename Compare>
+void ExternalSorter<T, Compare>::addRun(std::vector<T>& run)
+{
+    if (run.empty())
+        return;
+
+    pdqSort(run.begin(), run.end(), cmp_);
+
+    TempFile file = createRunFile(spillDirectory_);
+    if (file == nullptr || std::fwrite(run.data(), sizeof(T), run.size(), file.get()) != run.size() || std::fflush(file.get()) != 0)
+        throw std::runtime_error("Failed to write sorted run");
+
+    runs_.emplace_back(std::move(file), run.size());
+    run.clear();
+}
+
+// The fan-in is limited so that every merged run still gets a read buffer of a reasonable size.
+template <typename T, typename Compare>
+auto ExternalSorter<T, Compare>::fanIn() const -> std::size_t
+{
+    return std::clamp<std::size_t>(runCapacity_ * sizeof(T) / MIN_BUFFER_BYTES, 2, MAX_FAN_IN);
+}
+
+// While there are more runs than the fan-in, groups of consecutive runs are merged into longer runs
+// in the spill directory. The remaining runs are merged straight into the sink.
+template <typename T, typename Compare>
+template <typename Sink>
+void ExternalSorter<T, Compare>::merge(Sink sink)
+{
+    const auto maxRuns = fanIn();
+
+    while (runs_.size() > maxRuns)
+    {
+        std::vector<std::pair<TempFile, std::size_t>> merged;
+
+        for (std::size_t first = 0; first < runs_.size(); first += maxRuns)
+        {
+            const auto last = std::min(first + maxRuns, runs_.size());
+            if (last - first == 1)
+            {
+                merged.push_back(std::move(runs_[first]));
+                continue;
+            }
+
+            TempFile file = createRunFile(spillDirectory_);
+            if (file == nullptr)
+                throw std::runtime_error("Failed to write merged run");
+
+            std::size_t size = 0;
+            bool written = true;
+            mergeRuns(first, last, [&](const T& value) {
+                written = written && std::fwrite(&value, sizeof(T), 1, file.get()) == 1;
+                ++size;
+            });
+
+            if (!written || std::fflush(file.get()) != 0)
+                throw std::runtime_error("Failed to write merged run");
+
+            merged.emplace_back(std::move(file), size);
+        }
+
+        runs_ = std::move(merged);
+    }
+
+    mergeRuns(0, runs_.size(), sink);
+    runs_.clear();
+}
+
+// Every run gets an equal share of the memory budget as its read buffer (unless it is mapped).
+template <typename T, typename Compare>
+template <typename Sink>
+void ExternalSorter<T, Compare>::mergeRuns(std::size_t first, std::size_t last, Sink sink)
+{
+    if (first == last)
+        return;
+
+    const auto bufferSize = runCapacity_ / (last - first);
+    std::vector<RunReader<T>> readers;
+    readers.reserve(last - first);
+
+    for (auto i = first; i < last; ++i)
+        readers.emplace_back(std::move(runs_[i].first), runs_[i].second, bufferSize);
+
+    for (LoserTree<T, Compare> tree(readers, cmp_); !tree.empty(); tree.pop())
+        sink(tree.top());
+}
+
+} // namespace detail
+
+// External merge sort for data larger than memory. The input is cut into runs of memoryBudget
+// bytes, every run is sorted in memory and spilled to an unlinked file in spillDirectory (the system
+// temporary directory if empty), and the runs are merged through a loser tree straight into the
+// output. When there are more runs than one merge can read with reasonable buffers, groups of them
+// are first merged into longer runs. Runs are read back memory mapped where the platform supports
+// it. Elements must be trivially copyable.
+template <typename T, typename InputIt, typename OutputIt, typename Compare = std::less<>>
+void externalSort(InputIt first, InputIt last, OutputIt out, std::size_t memoryBudget, Compare cmp = Compare{},
+    const std::string& spillDirectory = "")
+{
+    static_assert(std::is_trivially_copyable_v<T>, "External sort requires trivially copyable elements");
+
+    detail::ExternalSorter<T, Compare> sorter(memoryBudget, cmp, spillDirectory);
+    std::vector<T> run;
+    run.reserve(sorter.runCapacity());
+
+    for (; first != last; ++first)
+    {
+        run.push_back(*first);
+        if (run.size() == sorter.runCapacity())
+            sorter.addRun(run);
+    }
+
+    sorter.addRun(run);
+    sorter.merge([&](const T& value) { *out++ = value; });
+}
+
+// Sort a binary file of T records into another file. The input size must be a whole number of records.
+template <typename T, typename Compare = std::less<>>
+void externalSort(const std::string& inputPath, const std::string& outputPath, std::size_t memoryBudget, Compare cmp = Compare{},
+    const std::string& spillDirectory = "")
+{
+    static_assert(std::is_trivially_copyable_v<T>, "External sort requires trivially copyable elements");
+
+    detail::TempFile input(std::fopen(inputPath.c_str(), "rb"));
+    if (input == nullptr)
+        throw std::runtime_error("Cannot open input file");
+
+    detail::ExternalSorter<T, Compare> sorter(memoryBudget, cmp, spillDirectory);
+    std::vector<T> run(sorter.runCapacity());
+
+    if (std::fseek(input.get(), 0, SEEK_END) != 0)
+        throw std::runtime_error("Cannot read input file");
+
+    const auto bytes = std::ftell(input.get());
+    if (bytes < 0 || bytes % sizeof(T) != 0)
+        throw std::runtime_error("Input file size is not a multiple of the record size");
+
+    std::rewind(input.get());
+
+    while (auto count = std::fread(run.data(), sizeof(T), run.size(), input.get()))
+    {
+        run.resize(count);
+        sorter.addRun(run);
+        run.resize(sorter.runCapacity());
+    }
+
+    if (std::ferror(input.get()) != 0)
+        throw std::runtime_error("Failed to read input file");
+
+    input.reset();
+
+    detail::TempFile output(std::fopen(outputPath.c_str(), "wb"));
+    if (output == nullptr)
+        throw std::runtime_error("Cannot open output file");
+
+    bool written = true;
+    sorter.merge([&](const T& value) { written = written && std::fwrite(&value, sizeof(T), 1, output.get()) == 1; });
+
+    if (!written || std::fflush(output.get()) != 0 || std::ferror(output.get()) != 0)
+        throw std::runtime_error("Failed to write output file");
+}
+
+} // namespace sort
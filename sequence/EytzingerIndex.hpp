@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+#include <sequence/Searcher.hpp>
+
+namespace search
+{
+// Static index over a sorted range stored in Eytzinger (BFS) order: the root is at position 1 and
+// the children of node k are at 2k and 2k + 1. A lookup walks down the implicit tree touching one
+// element per level, and the first levels share a few cache lines that stay hot. Since the 16
+// descendants of a node four levels down lie next to each other, they are prefetched while the
+// current levels are compared, which hides most of the memory latency of large indexes.
+// Lookups return ranks, i.e. positions in the original sorted range, so the index can be used to
+// search keys of an array of records.
+template <typename T, typename Compare = std::less<>>
+class EytzingerIndex
+{
+public:
+    template <typename It>
+    EytzingerIndex(It first, It last, Compare cmp = Compare{});
+
+    auto size() const -> std::size_t { return data_.size() - 1; }
+    bool empty() const { return size() == 0; }
+
+    // Rank of the first element not less than value, size() if there is none.
+    auto lowerBound(const T& value) const -> std::size_t;
+    bool contains(const T& value) const;
+
+private:
+    std::vector<T> data_;            // data_[0] is unused
+    std::vector<std::size_t> ranks_; // ranks_[k] is the sorted position of data_[k]
+    Compare cmp_;
+
+    template <typename It>
+    void build(It& it, std::size_t& rank, std::size_t k);
+    auto descend(const T& value) const -> std::size_t;
+};
+
+template <typename T, typename Compare>
+template <typename It>
+EytzingerIndex<T, Compare>::EytzingerIndex(It first, It last, Compare cmp) :
+    data_(static_cast<std::size_t>(std::distance(first, last)) + 1),
+    ranks_(data_.size()),
+    cmp_(cmp)
+{
+    std::size_t rank = 0;
+    build(first, rank, 1);
+}
+
+// In-order traversal of the implicit tree visits the nodes in sorted order.
+template <typename T, typename Compare>
+template <typename It>
+void EytzingerIndex<T, Compare>::build(It& it, std::size_t& rank, std::size_t k)
+{
+    if (k >= data_.size())
+        return;
+
+    build(it, rank, 2 * k);
+    data_[k] = *it++;
+    ranks_[k] = rank++;
+    build(it, rank, 2 * k + 1);
+}
+
+// Go left when the node is not less than value and right otherwise. The walk ends below a leaf,
+// and the lower bound is the last node where it went left: strip the trailing right turns (ones)
+// and then the left turn itself. Returns 0 if it never went left.
+template <typename T, typename Compare>
+auto EytzingerIndex<T, Compare>::descend(const T& value) const -> std::size_t
+{
+    constexpr std::size_t PREFETCH_DISTANCE = 16;
+
+    const auto n = size();
+    const auto* data = data_.data();
+    std::size_t k = 1;
+
+    while (k <= n)
+    {
+        detail::prefetch(reinterpret_cast<const void*>(reinterpret_cast<std::uintptr_t>(data) + PREFETCH_DISTANCE * k * sizeof(T)));
+        k = 2 * k + static_cast<std::size_t>(cmp_(data[k], value));
+    }
+
+    while (k & 1)
+        k >>= 1;
+
+    return k >> 1;
+}
+
+template <typename T, typename Compare>
+auto EytzingerIndex<T, Compare>::lowerBound(const T& value) const -> std::size_t
+{
+    const auto k = descend(value);
+    return k == 0 ? size() : ranks_[k];
+}
+
+template <typename T, typename Compare>
+bool EytzingerIndex<T, Compare>::contains(const T& value) const
+{
+    const auto k = descend(value);
+    return k != 0 && !cmp_(value, data_[k]);
+}
+
+} // namespace search
@@ -1,16 +1,367 @@
 #pragma once
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <functional>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#define SEARCH_SIMD_X86 1
+#endif
 
 namespace search
 {
+namespace detail
+{
+#ifdef SEARCH_SIMD_X86
+#define SEARCH_AVX2 __attribute__((target("avx2")))
+
+// Thin wrappers over the intrinsics of one instruction set, so every kernel below is written once
+// per instruction set and not once per element type. The integer wrappers load and store through
+// untyped pointers, so they serve every signed integer type of their width (see KernelType).
+template <typename T>
+struct Sse2;
+
+template <typename T>
+struct Avx2;
+
+template <>
+struct Sse2<std::int32_t>
+{
+    using Vector = __m128i;
+    static constexpr std::size_t WIDTH = 4;
+
+    static auto load(const void* ptr) -> Vector { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)); }
+    static auto broadcast(std::int32_t value) -> Vector { return _mm_set1_epi32(value); }
+    static auto select(Vector mask, Vector a, Vector b) -> Vector { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+    static auto min(Vector a, Vector b) -> Vector { return select(_mm_cmplt_epi32(a, b), a, b); }
+    static auto max(Vector a, Vector b) -> Vector { return select(_mm_cmpgt_epi32(a, b), a, b); }
+    static int equal(Vector a, Vector b) { return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b))); }
+    static int unordered(Vector) { return 0; }
+    static void store(void* ptr, Vector v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), v); }
+};
+
+template <>
+struct Sse2<float>
+{
+    using Vector = __m128;
+    static constexpr std::size_t WIDTH = 4;
+
+    static auto load(const float* ptr) -> Vector { return _mm_loadu_ps(ptr); }
+    static auto broadcast(float value) -> Vector { return _mm_set1_ps(value); }
+    static auto min(Vector a, Vector b) -> Vector { return _mm_min_ps(a, b); }
+    static auto max(Vector a, Vector b) -> Vector { return _mm_max_ps(a, b); }
+    static int equal(Vector a, Vector b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)); }
+    static int unordered(Vector v) { return _mm_movemask_ps(_mm_cmpunord_ps(v, v)); }
+    static void store(float* ptr, Vector v) { _mm_storeu_ps(ptr, v); }
+};
+
+template <>
+struct Sse2<double>
+{
+    using Vector = __m128d;
+    static constexpr std::size_t WIDTH = 2;
+
+    static auto load(const double* ptr) -> Vector { return _mm_loadu_pd(ptr); }
+    static auto broadcast(double value) -> Vector { return _mm_set1_pd(value); }
+    static auto min(Vector a, Vector b) -> Vector { return _mm_min_pd(a, b); }
+    static auto max(Vector a, Vector b) -> Vector { return _mm_max_pd(a, b); }
+    static int equal(Vector a, Vector b) { return _mm_movemask_pd(_mm_cmpeq_pd(a, b)); }
+    static int unordered(Vector v) { return _mm_movemask_pd(_mm_cmpunord_pd(v, v)); }
+    static void store(double* ptr, Vector v) { _mm_storeu_pd(ptr, v); }
+};
+
+template <>
+struct Avx2<std::int32_t>
+{
+    using Vector = __m256i;
+    static constexpr std::size_t WIDTH = 8;
+
+    SEARCH_AVX2 static auto load(const void* ptr) -> Vector { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr)); }
+    SEARCH_AVX2 static auto broadcast(std::int32_t value) -> Vector { return _mm256_set1_epi32(value); }
+    SEARCH_AVX2 static auto min(Vector a, Vector b) -> Vector { return _mm256_min_epi32(a, b); }
+    SEARCH_AVX2 static auto max(Vector a, Vector b) -> Vector { return _mm256_max_epi32(a, b); }
+    SEARCH_AVX2 static int equal(Vector a, Vector b) { return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b))); }
+    SEARCH_AVX2 static int unordered(Vector) { return 0; }
+    SEARCH_AVX2 static void store(void* ptr, Vector v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), v); }
+};
+
+template <>
+struct Avx2<std::int64_t>
+{
+    using Vector = __m256i;
+    static constexpr std::size_t WIDTH = 4;
+
+    SEARCH_AVX2 static auto load(const void* ptr) -> Vector { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr)); }
+    SEARCH_AVX2 static auto broadcast(std::int64_t value) -> Vector { return _mm256_set1_epi64x(value); }
+    SEARCH_AVX2 static int equal(Vector a, Vector b) { return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b))); }
+};
+
+template <>
+struct Avx2<float>
+{
+    using Vector = __m256;
+    static constexpr std::size_t WIDTH = 8;
+
+    SEARCH_AVX2 static auto load(const float* ptr) -> Vector { return _mm256_loadu_ps(ptr); }
+    SEARCH_AVX2 static auto broadcast(float value) -> Vector { return _mm256_set1_ps(value); }
+    SEARCH_AVX2 static auto min(Vector a, Vector b) -> Vector { return _mm256_min_ps(a, b); }
+    SEARCH_AVX2 static auto max(Vector a, Vector b) -> Vector { return _mm256_max_ps(a, b); }
+    SEARCH_AVX2 static int equal(Vector a, Vector b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)); }
+    SEARCH_AVX2 static int unordered(Vector v) { return _mm256_movemask_ps(_mm256_cmp_ps(v, v, _CMP_UNORD_Q)); }
+    SEARCH_AVX2 static void store(float* ptr, Vector v) { _mm256_storeu_ps(ptr, v); }
+};
+
+template <>
+struct Avx2<double>
+{
+    using Vector = __m256d;
+    static constexpr std::size_t WIDTH = 4;
+
+    SEARCH_AVX2 static auto load(const double* ptr) -> Vector { return _mm256_loadu_pd(ptr); }
+    SEARCH_AVX2 static auto broadcast(double value) -> Vector { return _mm256_set1_pd(value); }
+    SEARCH_AVX2 static auto min(Vector a, Vector b) -> Vector { return _mm256_min_pd(a, b); }
+    SEARCH_AVX2 static auto max(Vector a, Vector b) -> Vector { return _mm256_max_pd(a, b); }
+    SEARCH_AVX2 static int equal(Vector a, Vector b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)); }
+    SEARCH_AVX2 static int unordered(Vector v) { return _mm256_movemask_pd(_mm256_cmp_pd(v, v, _CMP_UNORD_Q)); }
+    SEARCH_AVX2 static void store(double* ptr, Vector v) { _mm256_storeu_pd(ptr, v); }
+};
+
+inline bool hasAvx2()
+{
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+
+// Index of the first element equal to value, or size if there is none.
+template <typename Ops, typename T>
+auto sse2Find(const T* data, std::size_t size, T value) -> std::size_t
+{
+    const auto needle = Ops::broadcast(value);
+    std::size_t i = 0;
+
+    for (; i + Ops::WIDTH <= size; i += Ops::WIDTH)
+    {
+        if (const int mask = Ops::equal(Ops::load(data + i), needle))
+            return i + __builtin_ctz(mask);
+    }
+
+    for (; i < size && !(data[i] == value); ++i);
+    return i;
+}
+
+template <typename Ops, typename T>
+SEARCH_AVX2 auto avx2Find(const T* data, std::size_t size, T value) -> std::size_t
+{
+    const auto needle = Ops::broadcast(value);
+    std::size_t i = 0;
+
+    for (; i + 2 * Ops::WIDTH <= size; i += 2 * Ops::WIDTH)
+    {
+        const int mask1 = Ops::equal(Ops::load(data + i), needle);
+        const int mask2 = Ops::equal(Ops::load(data + i + Ops::WIDTH), needle);
+
+        if ((mask1 | mask2) != 0)
+            return i + (mask1 != 0 ? __builtin_ctz(mask1) : Ops::WIDTH + __builtin_ctz(mask2));
+    }
+
+    for (; i < size && !(data[i] == value); ++i);
+    return i;
+}
+
+// Smallest (or largest) value of a non-empty range. Sets unordered if the range contains NaN,
+// in which case the result is meaningless and the caller has to use the scalar loop.
+template <typename Ops, bool Max, typename T>
+auto sse2Extreme(const T* data, std::size_t size, bool& unordered) -> T
+{
+    T result = data[0];
+    std::size_t i = 0;
+
+    if (size >= Ops::WIDTH)
+    {
+        auto acc = Ops::load(data);
+        int nan = 0;
+
+        for (; i + Ops::WIDTH <= size; i += Ops::WIDTH)
+        {
+            const auto v = Ops::load(data + i);
+            acc = Max ? Ops::max(acc, v) : Ops::min(acc, v);
+            nan |= Ops::unordered(v);
+        }
+
+        T lanes[Ops::WIDTH];
+        Ops::store(lanes, acc);
+        result = Max ? *std::max_element(lanes, lanes + Ops::WIDTH) : *std::min_element(lanes, lanes + Ops::WIDTH);
+        unordered = nan != 0;
+    }
+
+    for (; i < size; ++i)
+    {
+        unordered |= data[i] != data[i];
+        result = Max ? std::max(result, data[i]) : std::min(result, data[i]);
+    }
+
+    return result;
+}
+
+template <typename Ops, bool Max, typename T>
+SEARCH_AVX2 auto avx2Extreme(const T* data, std::size_t size, bool& unordered) -> T
+{
+    T result = data[0];
+    std::size_t i = 0;
+
+    if (size >= 2 * Ops::WIDTH)
+    {
+        auto acc1 = Ops::load(data);
+        auto acc2 = Ops::load(data + Ops::WIDTH);
+        int nan = 0;
+
+        for (; i + 2 * Ops::WIDTH <= size; i += 2 * Ops::WIDTH)
+        {
+            const auto v1 = Ops::load(data + i);
+            const auto v2 = Ops::load(data + i + Ops::WIDTH);
+            acc1 = Max ? Ops::max(acc1, v1) : Ops::min(acc1, v1);
+            acc2 = Max ? Ops::max(acc2, v2) : Ops::min(acc2, v2);
+            nan |= Ops::unordered(v1) | Ops::unordered(v2);
+        }
+
+        T lanes[Ops::WIDTH];
+        Ops::store(lanes, Max ? Ops::max(acc1, acc2) : Ops::min(acc1, acc2));
+        result = Max ? *std::max_element(lanes, lanes + Ops::WIDTH) : *std::min_element(lanes, lanes + Ops::WIDTH);
+        unordered = nan != 0;
+    }
+
+    for (; i < size; ++i)
+    {
+        unordered |= data[i] != data[i];
+        result = Max ? std::max(result, data[i]) : std::min(result, data[i]);
+    }
+
+    return result;
+}
+
+#undef SEARCH_AVX2
+#endif
+
+inline void prefetch(const void* ptr)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(ptr);
+#else
+    (void)ptr;
+#endif
+}
+
+// Iterators whose elements are stored contiguously (checked for pointers and vector iterators).
+template <typename It>
+constexpr bool isContiguous()
+{
+    using T = std::remove_const_t<typename std::iterator_traits<It>::value_type>;
+    return std::is_pointer_v<It> ||
+        std::is_same_v<It, typename std::vector<T>::iterator> ||
+        std::is_same_v<It, typename std::vector<T>::const_iterator>;
+}
+
+// Element type of the kernel used for T. Signed integers are matched by width and not by the exact
+// typedef, so long and long long both use the int64_t kernel on LP64.
+template <typename T>
+using KernelType = std::conditional_t<std::is_integral_v<T> && std::is_signed_v<T> && sizeof(T) == 4, std::int32_t,
+    std::conditional_t<std::is_integral_v<T> && std::is_signed_v<T> && sizeof(T) == 8, std::int64_t, T>>;
+
+// The element types which have vector kernels for the given operation.
+template <typename It, typename Compare, typename Default>
+constexpr bool hasExtremeKernel()
+{
+    using T = std::remove_const_t<typename std::iterator_traits<It>::value_type>;
+#ifdef SEARCH_SIMD_X86
+    using K = KernelType<T>;
+    return isContiguous<It>() && std::is_same_v<Compare, Default> &&
+        (std::is_same_v<K, std::int32_t> || std::is_same_v<K, float> || std::is_same_v<K, double>);
+#else
+    return false;
+#endif
+}
+
+template <typename It, typename U, typename Compare>
+constexpr bool hasFindKernel()
+{
+    using T = std::remove_const_t<typename std::iterator_traits<It>::value_type>;
+#ifdef SEARCH_SIMD_X86
+    using K = KernelType<T>;
+    return isContiguous<It>() && std::is_same_v<Compare, std::equal_to<>> && std::is_same_v<T, U> &&
+        (std::is_same_v<K, std::int32_t> || std::is_same_v<K, std::int64_t> || std::is_same_v<K, float> || std::is_same_v<K, double>);
+#else
+    return false;
+#endif
+}
+
+template <typename T>
+auto simdFind(const T* data, std::size_t size, T value) -> std::size_t
+{
+#ifdef SEARCH_SIMD_X86
+    using K = KernelType<T>;
+
+    if constexpr (std::is_same_v<K, std::int64_t>)
+    {
+        if (hasAvx2())
+            return avx2Find<Avx2<K>>(data, size, value);
+        return std::find(data, data + size, value) - data;
+    }
+    else
+    {
+        if (hasAvx2())
+            return avx2Find<Avx2<K>>(data, size, value);
+        return sse2Find<Sse2<K>>(data, size, value);
+    }
+#else
+    return std::find(data, data + size, value) - data;
+#endif
+}
+
+// Vector version of findMinimum/findMaximum. Finds the extreme value first and then its first
+// occurrence, which matches the scalar loop. Falls back to the scalar loop if there is a NaN.
+template <bool Max, typename It>
+auto simdExtreme(It first, It last, bool& handled) -> It
+{
+    using T = std::remove_const_t<typename std::iterator_traits<It>::value_type>;
+    const T* data = &*first;
+    const auto size = static_cast<std::size_t>(last - first);
+    bool unordered = false;
+    T value{};
+
+#ifdef SEARCH_SIMD_X86
+    if (hasAvx2())
+        value = avx2Extreme<Avx2<KernelType<T>>, Max>(data, size, unordered);
+    else
+        value = sse2Extreme<Sse2<KernelType<T>>, Max>(data, size, unordered);
+#endif
+
+    handled = !unordered;
+    return handled ? first + simdFind(data, size, value) : last;
+}
+
+} // namespace detail
+
+// Contiguous ranges of 32-bit signed integers, float and double with the default comparator are
+// scanned with AVX2 or SSE2 kernels chosen at runtime. The result is the same as of the scalar loop.
 template <typename It, typename Compare = std::less<>>
 auto findMinimum(It first, It last, Compare cmp = Compare{}) -> It
 {
     if (first == last)
         return last;
 
+    if constexpr (detail::hasExtremeKernel<It, Compare, std::less<>>())
+    {
+        bool handled = false;
+        const auto minIt = detail::simdExtreme<false>(first, last, handled);
+        if (handled)
+            return minIt;
+    }
+
     auto minIt = first;
     ++first;
 
@@ -29,6 +380,14 @@ auto findMaximum(It first, It last, Compare cmp = Compare{}) -> It
     if (first == last)
         return last;
 
+    if constexpr (detail::hasExtremeKernel<It, Compare, std::greater<>>())
+    {
+        bool handled = false;
+        const auto maxIt = detail::simdExtreme<true>(first, last, handled);
+        if (handled)
+            return maxIt;
+    }
+
     auto maxIt = first;
     ++first;
 
@@ -41,9 +400,19 @@ auto findMaximum(It first, It last, Compare cmp = Compare{}) -> It
     return maxIt;
 }
 
+// Contiguous ranges of 32 and 64-bit signed integers, float and double searched for a value of the
+// same type with the default comparator are scanned with vector kernels chosen at runtime.
 template <typename It, typename T, typename Compare = std::equal_to<>>
 auto linearSearch(It first, It last, const T& value, Compare cmp = Compare{}) -> It
 {
+    if constexpr (detail::hasFindKernel<It, T, Compare>())
+    {
+        if (first == last)
+            return last;
+
+        return first + detail::simdFind(&*first, static_cast<std::size_t>(last - first), value);
+    }
+
     for (; first != last; ++first)
     {
         if (cmp(*first, value))
@@ -53,74 +422,219 @@ auto linearSearch(It first, It last, const T& value, Compare cmp = Compare{}) ->
     return last;
 }
 
+// Lower bound for random access ranges without a data dependent branch: the comparison only selects
+// the next base, which compiles to a conditional move. The halving is fixed by the size alone,
+// so the CPU never mispredicts and can prefetch both possible next probes.
+template <typename It, typename T, typename Compare = std::less<>>
+auto branchlessLowerBound(It first, It last, const T& value, Compare cmp = Compare{}) -> It
+{
+    auto size = last - first;
+    if (size == 0)
+        return first;
+
+    auto base = first;
+    while (size > 1)
+    {
+        const auto half = size / 2;
+        detail::prefetch(&base[half / 2]);
+        detail::prefetch(&base[half + half / 2]);
+        base = cmp(base[half], value) ? base + half : base;
+        size -= half;
+    }
+
+    return base + cmp(*base, value);
+}
+
+// Return the first element equal to value or last if there is none.
 template <typename It, typename T, typename Compare = std::less<>>
 auto binarySearch(It first, It last, const T& value, Compare cmp = Compare{}) -> It
 {
-    if (first == last)
-        return last;
+    using Category = typename std::iterator_traits<It>::iterator_category;
+
+    It it;
+    if constexpr (std::is_base_of_v<std::random_access_iterator_tag, Category>)
+        it = branchlessLowerBound(first, last, value, cmp);
+    else
+        it = std::lower_bound(first, last, value, cmp);
+
+    return it != last && !cmp(value, *it) ? it : last;
+}
 
-    auto dist = std::distance(first, last);
-    auto lowIt = first;
-    auto highIt = first;
-    std::advance(highIt, dist - 1);
+// Interpolation search for arithmetic keys, a binary search otherwise. Every probe is interpolated
+// from the keys at both ends of the interval, and since on uniform data its error is about the
+// square root of the interval, a guard probe that far behind it usually cuts the interval to that
+// size, which gives O(log log n) probes. Whenever a round does not halve the interval it is
+// followed by a bisection, so skewed data still takes O(log n) probes. The position is computed
+// in floating point, which can't overflow and is safe on runs of equal keys because the keys at
+// the interval ends always differ there.
+template <typename It, typename T, typename Compare = std::less<>>
+auto interpolationSearch(It first, It last, const T& value, Compare cmp = Compare{}) -> It
+{
+    using Category = typename std::iterator_traits<It>::iterator_category;
+    using Value = typename std::iterator_traits<It>::value_type;
 
-    while (dist > 0 && !cmp(value, *lowIt) && !cmp(*highIt, value))
+    if constexpr (!std::is_base_of_v<std::random_access_iterator_tag, Category> || !std::is_arithmetic_v<Value> || !std::is_arithmetic_v<T>)
+        return binarySearch(first, last, value, cmp);
+    else
     {
-        const auto pos = dist / 2;
-        auto newIt = lowIt;
-        std::advance(newIt, pos);
+        constexpr std::ptrdiff_t BINARY_SEARCH_THRESHOLD = 16;
 
-        if (cmp(*newIt, value))
-        {
-            std::advance(lowIt, pos + 1);
-        }
-        else if (cmp(value, *newIt))
+        // The lower bound lies in [low, high].
+        std::ptrdiff_t low = 0;
+        std::ptrdiff_t high = last - first;
+
+        // Move the bounds past one probe.
+        const auto probe = [&](std::ptrdiff_t pos) {
+            if (cmp(first[pos], value))
+                low = pos + 1;
+            else
+                high = pos;
+        };
+
+        while (high - low > BINARY_SEARCH_THRESHOLD)
         {
-            highIt = lowIt;
-            std::advance(highIt, pos);
+            if (!cmp(first[low], value))
+            {
+                high = low;
+                break;
+            }
+            if (cmp(first[high - 1], value))
+            {
+                low = high;
+                break;
+            }
+
+            // Now first[low] < value <= first[high - 1], so the keys at both ends differ.
+            const auto lowKey = static_cast<double>(first[low]);
+            const auto highKey = static_cast<double>(first[high - 1]);
+            auto fraction = (static_cast<double>(value) - lowKey) / (highKey - lowKey);
+            if (!(fraction >= 0)) // also catches NaN
+                fraction = 0;
+            if (fraction > 1)
+                fraction = 1;
+
+            const auto size = high - low;
+            const auto guard = static_cast<std::ptrdiff_t>(std::sqrt(static_cast<double>(size)));
+            const auto pos = low + static_cast<std::ptrdiff_t>(fraction * static_cast<double>(size - 1));
+            probe(pos);
+
+            if (low == pos + 1 && pos + guard < high)
+                probe(pos + guard);
+            else if (high == pos && pos - guard > low)
+                probe(pos - guard);
+
+            if (2 * (high - low) > size)
+                probe(low + (high - low) / 2);
         }
-        else
-            return std::lower_bound(lowIt, newIt, value);
 
-        dist = std::distance(lowIt, highIt);
+        const auto it = branchlessLowerBound(first + low, first + high, value, cmp);
+        return it != last && !cmp(value, *it) ? it : last;
     }
+}
 
-    return last;
+namespace detail
+{
+constexpr std::size_t BATCH_GROUP_SIZE = 16;
+
+// Exponential search from first, for a value expected close to the front of the range.
+template <typename It, typename T, typename Compare>
+auto gallopLowerBound(It first, It last, const T& value, Compare cmp) -> It
+{
+    const auto size = last - first;
+    decltype(last - first) bound = 1;
+
+    while (bound < size && cmp(first[bound - 1], value))
+        bound *= 2;
+
+    return branchlessLowerBound(first + bound / 2, first + std::min(bound, size), value, cmp);
 }
 
-template <typename It, typename T, typename Compare = std::less<>>
-auto interpolationSearch(It first, It last, const T& value, Compare cmp = Compare{}) -> It
+// Sorted queries: every lower bound starts where the previous one ended, so the whole batch is a
+// merge of both ranges that skips ahead by galloping.
+template <typename It, typename QueryIt, typename Compare>
+void sweepSearch(It first, It last, QueryIt qFirst, QueryIt qLast, std::vector<It>& result, Compare cmp)
 {
-    if (first == last)
-        return last;
+    auto pos = first;
+
+    for (; qFirst != qLast; ++qFirst)
+    {
+        pos = gallopLowerBound(pos, last, *qFirst, cmp);
+        result.push_back(pos != last && !cmp(*qFirst, *pos) ? pos : last);
+    }
+}
 
-    auto dist = std::distance(first, last);
-    auto lowIt = first;
-    auto highIt = first;
-    std::advance(highIt, dist - 1);
+// Unsorted queries: a group of branchless searches runs in lockstep. All of them halve the same
+// size, so after every step the next probe of each query is known and prefetched, and the cache
+// misses of the whole group overlap instead of being paid one after another.
+template <typename It, typename QueryIt, typename Compare>
+void interleavedSearch(It first, It last, QueryIt qFirst, QueryIt qLast, std::vector<It>& result, Compare cmp)
+{
+    const auto n = last - first;
+    QueryIt keys[BATCH_GROUP_SIZE];
+    It base[BATCH_GROUP_SIZE];
 
-    while (dist > 0 && !cmp(value, *lowIt) && !cmp(*highIt, value))
+    while (qFirst != qLast)
     {
-        const auto pos = (value - *lowIt) * dist / (*highIt - *lowIt);
-        auto newIt = lowIt;
-        std::advance(newIt, pos);
+        std::size_t count = 0;
+        for (; count < BATCH_GROUP_SIZE && qFirst != qLast; ++count, ++qFirst)
+        {
+            keys[count] = qFirst;
+            base[count] = first;
+        }
 
-        if (cmp(*newIt, value))
+        if (n == 0)
         {
-            std::advance(lowIt, pos + 1);
+            result.insert(result.end(), count, last);
+            continue;
         }
-        else if (cmp(value, *newIt))
+
+        for (auto size = n; size > 1;)
         {
-            highIt = lowIt;
-            std::advance(highIt, pos - 1);
+            const auto half = size / 2;
+            size -= half;
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                base[i] = cmp(base[i][half], *keys[i]) ? base[i] + half : base[i];
+                prefetch(&base[i][size / 2]);
+            }
         }
-        else
-            return std::lower_bound(lowIt, newIt, value);
 
-        dist = std::distance(lowIt, highIt);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const auto it = base[i] + cmp(*base[i], *keys[i]);
+            result.push_back(it != last && !cmp(*keys[i], *it) ? it : last);
+        }
     }
+}
 
-    return last;
+} // namespace detail
+
+// Binary search of every query in [qFirst, qLast) at once. The result holds, in query order, the
+// first element equal to each query or last if there is none. Sorted queries are answered by a
+// single galloping sweep over the range, others are searched in interleaved groups.
+template <typename It, typename QueryIt, typename Compare = std::less<>>
+auto batchBinarySearch(It first, It last, QueryIt qFirst, QueryIt qLast, Compare cmp = Compare{}) -> std::vector<It>
+{
+    using Category = typename std::iterator_traits<It>::iterator_category;
+
+    std::vector<It> result;
+    result.reserve(static_cast<std::size_t>(std::distance(qFirst, qLast)));
+
+    if constexpr (std::is_base_of_v<std::random_access_iterator_tag, Category>)
+    {
+        if (std::is_sorted(qFirst, qLast, cmp))
+            detail::sweepSearch(first, last, qFirst, qLast, result, cmp);
+        else
+            detail::interleavedSearch(first, last, qFirst, qLast, result, cmp);
+    }
+    else
+    {
+        for (; qFirst != qLast; ++qFirst)
+            result.push_back(binarySearch(first, last, *qFirst, cmp));
+    }
+
+    return result;
 }
 
 } // namespace search
@@ -2,6 +2,13 @@
 
 #include <algorithm>
 #include <functional>
+#include <future>
+#include <iterator>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace sort
 {
@@ -42,19 +49,152 @@ void selectionSort(It first, It last, Compare cmp = Compare{})
     }
 }
 
+namespace detail
+{
+// Ranges up to this size are finished by insertion sort inside introSort.
+constexpr std::ptrdiff_t INSERTION_SORT_THRESHOLD = 16;
+
+// Ranges above this size take the pivot as the ninther (median of three medians).
+constexpr std::ptrdiff_t NINTHER_THRESHOLD = 128;
+
+// Plain insertion sort moving elements one by one, faster than insertionSort on short ranges.
+template <typename It, typename Compare>
+void linearInsertionSort(It first, It last, Compare cmp)
+{
+    if (first == last)
+        return;
+
+    for (auto it = std::next(first); it != last; ++it)
+    {
+        auto value = std::move(*it);
+        auto hole = it;
+
+        for (; hole != first && cmp(value, *std::prev(hole)); --hole)
+            *hole = std::move(*std::prev(hole));
+
+        *hole = std::move(value);
+    }
+}
+
+// Order the three elements in place and return the middle one.
+template <typename It, typename Compare>
+auto sortThree(It a, It b, It c, Compare cmp) -> It
+{
+    if (cmp(*b, *a))
+        std::iter_swap(a, b);
+    if (cmp(*c, *b))
+        std::iter_swap(b, c);
+    if (cmp(*b, *a))
+        std::iter_swap(a, b);
+    return b;
+}
+
+template <typename It, typename Compare>
+auto choosePivot(It first, It last, Compare cmp) -> It
+{
+    const auto size = last - first;
+    const auto mid = first + size / 2;
+
+    if (size <= NINTHER_THRESHOLD)
+        return sortThree(first, mid, last - 1, cmp);
+
+    const auto step = size / 8;
+    sortThree(first, first + step, first + 2 * step, cmp);
+    sortThree(mid - step, mid, mid + step, cmp);
+    sortThree(last - 1 - 2 * step, last - 1 - step, last - 1, cmp);
+    return sortThree(first + step, mid, last - 1 - step, cmp);
+}
+
+// Three-way partition in a single pass. Returns the bounds of the range equal to the pivot,
+// everything before is less and everything after is greater.
+template <typename It, typename T, typename Compare>
+auto partitionThreeWay(It first, It last, const T& pivot, Compare cmp) -> std::pair<It, It>
+{
+    auto lessIt = first;
+    auto greaterIt = last;
+
+    for (auto it = first; it < greaterIt;)
+    {
+        if (cmp(*it, pivot))
+            std::iter_swap(lessIt++, it++);
+        else if (cmp(pivot, *it))
+            std::iter_swap(it, --greaterIt);
+        else
+            ++it;
+    }
+
+    return { lessIt, greaterIt };
+}
+
+// Recurse into the smaller part and loop on the larger one, so the stack depth stays logarithmic.
+template <typename It, typename Compare>
+void introSortLoop(It first, It last, Compare cmp, int depthLimit)
+{
+    while (last - first > INSERTION_SORT_THRESHOLD)
+    {
+        if (depthLimit-- == 0)
+        {
+            std::make_heap(first, last, cmp);
+            std::sort_heap(first, last, cmp);
+            return;
+        }
+
+        const auto pivot = *choosePivot(first, last, cmp);
+        const auto [midIt1, midIt2] = partitionThreeWay(first, last, pivot, cmp);
+
+        if (midIt1 - first < last - midIt2)
+        {
+            introSortLoop(first, midIt1, cmp, depthLimit);
+            first = midIt2;
+        }
+        else
+        {
+            introSortLoop(midIt2, last, cmp, depthLimit);
+            last = midIt1;
+        }
+    }
+
+    linearInsertionSort(first, last, cmp);
+}
+
+} // namespace detail
+
+// Hybrid of quick sort, heap sort and insertion sort. The pivot is the median of three (ninther
+// for larger ranges) and the range is split into less, equal and greater parts in one pass.
+// Once the recursion gets deeper than 2 * log2(n) the range is finished by heap sort,
+// which bounds the worst case to O(n log n). Requires random access iterators.
+template <typename It, typename Compare = std::less<>>
+void introSort(It first, It last, Compare cmp = Compare{})
+{
+    int depthLimit = 0;
+    for (auto size = last - first; size > 1; size /= 2)
+        depthLimit += 2;
+
+    detail::introSortLoop(first, last, cmp, depthLimit);
+}
+
+// Random access ranges are sorted by introSort, other ranges by the plain recursive quick sort.
 template <typename It, typename Compare = std::less<>>
 void quickSort(It first, It last, Compare cmp = Compare{})
 {
-    const auto size = std::distance(first, last);
-    if (size <= 1)
-        return;
+    using Category = typename std::iterator_traits<It>::iterator_category;
+    if constexpr (std::is_base_of_v<std::random_access_iterator_tag, Category>)
+    {
+        introSort(first, last, cmp);
+    }
+    else
+    {
+        const auto size = std::distance(first, last);
+        if (size <= 1)
+            return;
 
-    const auto pivot = *std::next(first, size / 2);
-    const auto midIt1 = std::partition(first, last, [&](const auto& element) { return cmp(element, pivot); });
-    const auto midIt2 = std::partition(midIt1, last, [&](const auto& element) { return !cmp(pivot, element); });
+        const auto pivot = *std::next(first, size / 2);
+        const auto midIt1 = std::partition(first, last, [&](const auto& element) { return cmp(element, pivot); });
+        const auto midIt2 = std::partition(midIt1, last, [&](const auto& element) { return !cmp(pivot, element); });
 
-    quickSort(first, midIt1, cmp);
-    quickSort(midIt2, last, cmp);
+        quickSort(first, midIt1, cmp);
+        quickSort(midIt2, last, cmp);
+    }
 }
 
 template <typename It, typename Compare = std::less<>>
@@ -77,4 +217,997 @@ void heapSort(It first, It last, Compare cmp = Compare{})
     std::sort_heap(first, last, cmp);
 }
 
+namespace detail
+{
+// Ranges below the cutoff are not worth the cost of starting a task.
+constexpr std::ptrdiff_t PARALLEL_CUTOFF = 1 << 14;
+
+// Extra fork levels beyond one leaf task per thread, giving 4 leaf tasks per thread.
+constexpr int EXTRA_FORK_LEVELS = 2;
+
+// Number of fork levels for the given thread count, ceil(log2(threads)) plus the extra levels, or
+// none for a single thread. Quick sort partitions are uneven, and several smaller tasks per thread
+// even out the load. Every fork starts a new thread, which the OS schedules over the cores.
+inline auto forkDepth(std::size_t threads) -> int
+{
+    if (threads <= 1)
+        return 0;
+
+    int depth = EXTRA_FORK_LEVELS;
+    for (std::size_t t = 1; t < threads; t *= 2)
+        ++depth;
+    return depth;
+}
+
+template <typename It, typename Compare>
+void parallelQuickSort(It first, It last, Compare cmp, int depth)
+{
+    const auto size = std::distance(first, last);
+    if (depth == 0 || size < PARALLEL_CUTOFF)
+        return quickSort(first, last, cmp);
+
+    const auto pivot = *choosePivot(first, last, cmp);
+    const auto bounds = partitionThreeWay(first, last, pivot, cmp);
+
+    auto left = std::async(std::launch::async, [=] { parallelQuickSort(first, bounds.first, cmp, depth - 1); });
+    parallelQuickSort(bounds.second, last, cmp, depth - 1);
+    left.get();
+}
+
+// Stable merge of two sorted ranges into out. The larger range is split at its middle element
+// and the smaller one at the matching bound, and both halves are merged concurrently.
+template <typename It1, typename It2, typename OutIt, typename Compare>
+void parallelMerge(It1 first1, It1 last1, It2 first2, It2 last2, OutIt out, Compare cmp, int depth)
+{
+    const auto size1 = std::distance(first1, last1);
+    const auto size2 = std::distance(first2, last2);
+
+    if (depth == 0 || size1 + size2 < PARALLEL_CUTOFF)
+    {
+        std::merge(std::make_move_iterator(first1), std::make_move_iterator(last1),
+            std::make_move_iterator(first2), std::make_move_iterator(last2), out, cmp);
+        return;
+    }
+
+    It1 mid1;
+    It2 mid2;
+
+    if (size1 >= size2)
+    {
+        mid1 = std::next(first1, size1 / 2);
+        mid2 = std::lower_bound(first2, last2, *mid1, cmp);
+    }
+    else
+    {
+        mid2 = std::next(first2, size2 / 2);
+        mid1 = std::upper_bound(first1, last1, *mid2, cmp);
+    }
+
+    const auto outMid = std::next(out, std::distance(first1, mid1) + std::distance(first2, mid2));
+    auto left = std::async(std::launch::async, [=] { parallelMerge(first1, mid1, first2, mid2, out, cmp, depth - 1); });
+    parallelMerge(mid1, last1, mid2, last2, outMid, cmp, depth - 1);
+    left.get();
+}
+
+// Sorts the range either in place or into the buffer. The halves are sorted into the other storage
+// and merged back, so the levels alternate between the range and the buffer and no separate copy
+// pass is needed. Only the leaves sorted into the buffer copy their part, each in its own task.
+template <typename It, typename BufIt, typename Compare>
+void parallelMergeSort(It first, It last, BufIt buffer, Compare cmp, int depth, bool intoBuffer)
+{
+    const auto size = std::distance(first, last);
+    if (depth == 0 || size < PARALLEL_CUTOFF)
+    {
+        mergeSort(first, last, cmp);
+        if (intoBuffer)
+            std::move(first, last, buffer);
+        return;
+    }
+
+    const auto midIt = std::next(first, size / 2);
+    const auto bufferMid = std::next(buffer, size / 2);
+    const auto bufferLast = std::next(buffer, size);
+
+    auto left = std::async(std::launch::async, [=] { parallelMergeSort(first, midIt, buffer, cmp, depth - 1, !intoBuffer); });
+    parallelMergeSort(midIt, last, bufferMid, cmp, depth - 1, !intoBuffer);
+    left.get();
+
+    if (intoBuffer)
+        parallelMerge(first, midIt, midIt, last, buffer, cmp, depth);
+    else
+        parallelMerge(buffer, bufferMid, bufferMid, bufferLast, first, cmp, depth);
+}
+
+} // namespace detail
+
+// Fork-join quick sort. Partitions are sorted as separate tasks until there are about 4 tasks per
+// thread or the partition drops below the cutoff, then the sequential quickSort takes over. Each
+// partition step itself is sequential, so the top level partition of the whole range bounds the
+// speedup.
+template <typename It, typename Compare = std::less<>>
+void parallelQuickSort(It first, It last, Compare cmp = Compare{}, std::size_t threads = std::thread::hardware_concurrency())
+{
+    detail::parallelQuickSort(first, last, cmp, detail::forkDepth(threads));
+}
+
+// Fork-join merge sort. Both halves are sorted concurrently and merged in parallel into a buffer
+// allocated once for the whole sort. Small ranges fall back to the sequential mergeSort.
+template <typename It, typename Compare = std::less<>>
+void parallelMergeSort(It first, It last, Compare cmp = Compare{}, std::size_t threads = std::thread::hardware_concurrency())
+{
+    const int depth = detail::forkDepth(threads);
+    if (depth == 0 || std::distance(first, last) < detail::PARALLEL_CUTOFF)
+        return mergeSort(first, last, cmp);
+
+    std::vector<typename std::iterator_traits<It>::value_type> buffer(std::distance(first, last));
+    detail::parallelMergeSort(first, last, buffer.begin(), cmp, depth, false);
+}
+
+namespace detail
+{
+// Ranges up to this size are finished by insertion sort inside the string radix sort.
+constexpr std::ptrdiff_t RADIX_INSERTION_THRESHOLD = 32;
+
+struct Identity
+{
+    template <typename T>
+    auto operator()(T&& value) const -> T&&
+    {
+        return std::forward<T>(value);
+    }
+};
+
+// Map an integer to an unsigned one with the same order (the sign bit is flipped for signed types).
+template <typename T>
+auto radixKey(T key) -> std::make_unsigned_t<T>
+{
+    using U = std::make_unsigned_t<T>;
+    if constexpr (std::is_signed_v<T>)
+        return static_cast<U>(key) ^ (U(1) << (sizeof(T) * 8 - 1));
+    else
+        return key;
+}
+
+// LSD radix sort which moves the elements between the range and a buffer on every pass.
+// Histograms of all passes are built in one sweep, and a pass is skipped when all keys share
+// the digit. If an odd number of passes was made, the result is moved back from the buffer.
+template <std::size_t DigitBits, typename It, typename Key>
+void lsdRadixSort(It first, It last, Key key)
+{
+    using KeyType = std::decay_t<std::invoke_result_t<Key&, typename std::iterator_traits<It>::reference>>;
+    constexpr std::size_t KEY_BITS = sizeof(KeyType) * 8;
+    constexpr std::size_t PASSES = (KEY_BITS + DigitBits - 1) / DigitBits;
+    constexpr std::size_t BUCKETS = std::size_t(1) << DigitBits;
+    constexpr auto MASK = BUCKETS - 1;
+
+    const auto size = static_cast<std::size_t>(last - first);
+    if (size <= 1)
+        return;
+
+    std::vector<std::size_t> counts(PASSES * BUCKETS);
+    for (auto it = first; it != last; ++it)
+    {
+        const auto k = radixKey(key(*it));
+        for (std::size_t pass = 0; pass < PASSES; ++pass)
+            ++counts[pass * BUCKETS + ((k >> (pass * DigitBits)) & MASK)];
+    }
+
+    std::vector<typename std::iterator_traits<It>::value_type> buffer(size);
+    bool inBuffer = false;
+
+    auto scatter = [&](auto src, auto dst, std::size_t pass)
+    {
+        auto offsets = counts.begin() + pass * BUCKETS;
+        std::size_t sum = 0;
+        for (std::size_t b = 0; b < BUCKETS; ++b)
+        {
+            const auto count = offsets[b];
+            offsets[b] = sum;
+            sum += count;
+        }
+
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            const auto digit = (radixKey(key(src[i])) >> (pass * DigitBits)) & MASK;
+            dst[offsets[digit]++] = std::move(src[i]);
+        }
+    };
+
+    for (std::size_t pass = 0; pass < PASSES; ++pass)
+    {
+        const auto k = radixKey(key(inBuffer ? buffer.front() : *first));
+        if (counts[pass * BUCKETS + ((k >> (pass * DigitBits)) & MASK)] == size)
+            continue;
+
+        if (inBuffer)
+            scatter(buffer.begin(), first, pass);
+        else
+            scatter(first, buffer.begin(), pass);
+
+        inBuffer = !inBuffer;
+    }
+
+    if (inBuffer)
+        std::move(buffer.begin(), buffer.end(), first);
+}
+
+// MSD radix sort with American flag partitioning: the elements are distributed into 257 buckets
+// (end of string and one per byte) in place by following swap cycles, then every bucket except
+// the finished strings is sorted by the next byte.
+template <typename It, typename Key>
+void americanFlagSort(It first, It last, Key& key, std::size_t depth)
+{
+    constexpr std::size_t BUCKETS = 257;
+
+    if (last - first <= RADIX_INSERTION_THRESHOLD)
+    {
+        linearInsertionSort(first, last, [&](const auto& lhs, const auto& rhs)
+            {
+                return std::string_view(key(lhs)).substr(depth) < std::string_view(key(rhs)).substr(depth);
+            });
+        return;
+    }
+
+    auto bucket = [&](const auto& element) -> std::size_t
+    {
+        decltype(auto) k = key(element);
+        const std::string_view view = k;
+        return depth < view.size() ? 1 + static_cast<unsigned char>(view[depth]) : 0;
+    };
+
+    std::size_t counts[BUCKETS] = {};
+    for (auto it = first; it != last; ++it)
+        ++counts[bucket(*it)];
+
+    std::ptrdiff_t next[BUCKETS];
+    std::ptrdiff_t end[BUCKETS];
+    std::ptrdiff_t sum = 0;
+    for (std::size_t b = 0; b < BUCKETS; ++b)
+    {
+        next[b] = sum;
+        sum += counts[b];
+        end[b] = sum;
+    }
+
+    for (std::size_t b = 0; b < BUCKETS; ++b)
+    {
+        while (next[b] < end[b])
+        {
+            const auto target = bucket(first[next[b]]);
+            if (target == b)
+                ++next[b];
+            else
+                std::iter_swap(first + next[b], first + next[target]++);
+        }
+    }
+
+    for (std::size_t b = 1; b < BUCKETS; ++b)
+    {
+        if (counts[b] > 1)
+            americanFlagSort(first + (end[b] - counts[b]), first + end[b], key, depth + 1);
+    }
+}
+
+} // namespace detail
+
+// Non-comparison sort by a key extracted from every element (the element itself by default).
+// Integral keys are sorted by LSD radix sort with DigitBits wide digits (8, 11 or 16 are typical,
+// wider digits mean fewer passes but larger histograms). String keys, i.e. anything convertible
+// to std::string_view, are sorted by MSD American flag sort in place. Integral keys are sorted
+// stably, string keys are not. Requires random access iterators.
+template <std::size_t DigitBits = 8, typename It, typename Key = detail::Identity>
+void radixSort(It first, It last, Key key = Key{})
+{
+    static_assert(DigitBits > 0 && DigitBits <= 16, "Invalid digit width");
+
+    using KeyType = std::decay_t<std::invoke_result_t<Key&, typename std::iterator_traits<It>::reference>>;
+    constexpr bool integralKey = std::is_integral_v<KeyType> && !std::is_same_v<KeyType, bool>;
+
+    if constexpr (integralKey)
+        detail::lsdRadixSort<DigitBits>(first, last, key);
+    else if constexpr (std::is_convertible_v<const KeyType&, std::string_view>)
+        detail::americanFlagSort(first, last, key, 0);
+    else
+        static_assert(integralKey, "Radix sort requires non-bool integral or string keys");
+}
+
+namespace detail
+{
+// Constants of the pattern-defeating quick sort.
+constexpr std::ptrdiff_t PDQ_INSERTION_THRESHOLD = 24;
+constexpr std::ptrdiff_t PDQ_PARTIAL_INSERTION_LIMIT = 8;
+constexpr std::size_t PDQ_BLOCK_SIZE = 64;
+
+// Insertion sort which relies on the element before first being not greater than any element
+// in the range, so the inner loop needs no bounds check.
+template <typename It, typename Compare>
+void unguardedInsertionSort(It first, It last, Compare cmp)
+{
+    if (first == last)
+        return;
+
+    for (auto it = first + 1; it != last; ++it)
+    {
+        if (!cmp(*it, *(it - 1)))
+            continue;
+
+        auto value = std::move(*it);
+        auto hole = it;
+        do
+        {
+            *hole = std::move(*(hole - 1));
+            --hole;
+        }
+        while (cmp(value, *(hole - 1)));
+
+        *hole = std::move(value);
+    }
+}
+
+// Insertion sort which gives up once more than PDQ_PARTIAL_INSERTION_LIMIT elements were moved.
+// Returns whether the range was sorted.
+template <typename It, typename Compare>
+bool partialInsertionSort(It first, It last, Compare cmp)
+{
+    if (first == last)
+        return true;
+
+    std::ptrdiff_t moved = 0;
+    for (auto it = first + 1; it != last; ++it)
+    {
+        if (cmp(*it, *(it - 1)))
+        {
+            auto value = std::move(*it);
+            auto hole = it;
+            do
+            {
+                *hole = std::move(*(hole - 1));
+                --hole;
+            }
+            while (hole != first && cmp(value, *(hole - 1)));
+
+            *hole = std::move(value);
+            moved += it - hole;
+        }
+
+        if (moved > PDQ_PARTIAL_INSERTION_LIMIT)
+            return false;
+    }
+
+    return true;
+}
+
+// Exchange the misplaced elements recorded by the block partition. With unequal counts the
+// elements are rotated through a cyclic permutation, which needs fewer moves than swapping.
+template <typename It>
+void swapOffsets(It first, It last, const unsigned char* offsetsL, const unsigned char* offsetsR, std::size_t count, bool useSwaps)
+{
+    if (useSwaps)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            std::iter_swap(first + offsetsL[i], last - offsetsR[i]);
+    }
+    else if (count > 0)
+    {
+        auto l = first + offsetsL[0];
+        auto r = last - offsetsR[0];
+        auto tmp = std::move(*l);
+        *l = std::move(*r);
+
+        for (std::size_t i = 1; i < count; ++i)
+        {
+            l = first + offsetsL[i];
+            *r = std::move(*l);
+            r = last - offsetsR[i];
+            *l = std::move(*r);
+        }
+
+        *r = std::move(tmp);
+    }
+}
+
+// BlockQuicksort partition around the pivot at *first. Elements equal to the pivot go right.
+// Each side is scanned a block at a time and the offsets of misplaced elements are recorded
+// without branching on the comparison, then the recorded elements are swapped in bulk.
+// Returns the final pivot position and whether the range was already partitioned.
+template <typename It, typename Compare>
+auto partitionRightBranchless(It begin, It end, Compare cmp) -> std::pair<It, bool>
+{
+    auto pivot = std::move(*begin);
+    auto first = begin;
+    auto last = end;
+
+    while (cmp(*++first, pivot));
+
+    if (first - 1 == begin)
+        while (first < last && !cmp(*--last, pivot));
+    else
+        while (!cmp(*--last, pivot));
+
+    const bool alreadyPartitioned = first >= last;
+
+    if (!alreadyPartitioned)
+    {
+        std::iter_swap(first, last);
+        ++first;
+
+        alignas(64) unsigned char offsetsL[PDQ_BLOCK_SIZE];
+        alignas(64) unsigned char offsetsR[PDQ_BLOCK_SIZE];
+
+        auto baseL = first;
+        auto baseR = last;
+        std::size_t countL = 0;
+        std::size_t countR = 0;
+        std::size_t startL = 0;
+        std::size_t startR = 0;
+
+        while (first < last)
+        {
+            const auto unknown = static_cast<std::size_t>(last - first);
+            const auto splitL = countL == 0 ? (countR == 0 ? unknown / 2 : unknown) : 0;
+            const auto splitR = countR == 0 ? unknown - splitL : 0;
+
+            for (std::size_t i = 0; i < std::min(splitL, PDQ_BLOCK_SIZE);)
+            {
+                offsetsL[countL] = static_cast<unsigned char>(i++);
+                countL += !cmp(*first, pivot);
+                ++first;
+            }
+
+            for (std::size_t i = 0; i < std::min(splitR, PDQ_BLOCK_SIZE);)
+            {
+                offsetsR[countR] = static_cast<unsigned char>(++i);
+                countR += cmp(*--last, pivot);
+            }
+
+            const auto count = std::min(countL, countR);
+            swapOffsets(baseL, baseR, offsetsL + startL, offsetsR + startR, count, countL == countR);
+            countL -= count;
+            countR -= count;
+            startL += count;
+            startR += count;
+
+            if (countL == 0)
+            {
+                startL = 0;
+                baseL = first;
+            }
+
+            if (countR == 0)
+            {
+                startR = 0;
+                baseR = last;
+            }
+        }
+
+        // Move the remaining misplaced elements of one side to the boundary.
+        if (countL > 0)
+        {
+            while (countL-- > 0)
+                std::iter_swap(baseL + offsetsL[startL + countL], --last);
+            first = last;
+        }
+
+        if (countR > 0)
+        {
+            while (countR-- > 0)
+                std::iter_swap(baseR - offsetsR[startR + countR], first++);
+            last = first;
+        }
+    }
+
+    auto pivotIt = first - 1;
+    *begin = std::move(*pivotIt);
+    *pivotIt = std::move(pivot);
+    return { pivotIt, alreadyPartitioned };
+}
+
+// Partition around the pivot at *first with elements equal to the pivot going left. Used when
+// the pivot equals the element before the range, so the whole left part can be skipped.
+template <typename It, typename Compare>
+auto partitionLeft(It begin, It end, Compare cmp) -> It
+{
+    auto pivot = std::move(*begin);
+    auto first = begin;
+    auto last = end;
+
+    while (cmp(pivot, *--last));
+
+    if (last + 1 == end)
+        while (first < last && !cmp(pivot, *++first));
+    else
+        while (!cmp(pivot, *++first));
+
+    while (first < last)
+    {
+        std::iter_swap(first, last);
+        while (cmp(pivot, *--last));
+        while (!cmp(pivot, *++first));
+    }
+
+    *begin = std::move(*last);
+    *last = std::move(pivot);
+    return last;
+}
+
+template <typename It, typename Compare>
+void pdqSortLoop(It begin, It end, Compare cmp, int badAllowed, bool leftmost)
+{
+    while (true)
+    {
+        const auto size = end - begin;
+
+        if (size < PDQ_INSERTION_THRESHOLD)
+        {
+            if (leftmost)
+                linearInsertionSort(begin, end, cmp);
+            else
+                unguardedInsertionSort(begin, end, cmp);
+            return;
+        }
+
+        // Move the median of three (or ninther) to the front as the pivot.
+        const auto half = size / 2;
+        if (size > NINTHER_THRESHOLD)
+        {
+            sortThree(begin, begin + half, end - 1, cmp);
+            sortThree(begin + 1, begin + (half - 1), end - 2, cmp);
+            sortThree(begin + 2, begin + (half + 1), end - 3, cmp);
+            sortThree(begin + (half - 1), begin + half, begin + (half + 1), cmp);
+            std::iter_swap(begin, begin + half);
+        }
+        else
+            sortThree(begin + half, begin, end - 1, cmp);
+
+        // A pivot equal to the predecessor of the range means many equal elements.
+        if (!leftmost && !cmp(*(begin - 1), *begin))
+        {
+            begin = partitionLeft(begin, end, cmp) + 1;
+            continue;
+        }
+
+        const auto [pivotIt, alreadyPartitioned] = partitionRightBranchless(begin, end, cmp);
+        const auto sizeL = pivotIt - begin;
+        const auto sizeR = end - (pivotIt + 1);
+
+        if (sizeL < size / 8 || sizeR < size / 8)
+        {
+            // Too many bad partitions, fall back to heap sort for a guaranteed O(n log n).
+            if (--badAllowed == 0)
+            {
+                std::make_heap(begin, end, cmp);
+                std::sort_heap(begin, end, cmp);
+                return;
+            }
+
+            // Break patterns by swapping a few elements into new positions.
+            if (sizeL >= PDQ_INSERTION_THRESHOLD)
+            {
+                std::iter_swap(begin, begin + sizeL / 4);
+                std::iter_swap(pivotIt - 1, pivotIt - sizeL / 4);
+
+                if (sizeL > NINTHER_THRESHOLD)
+                {
+                    std::iter_swap(begin + 1, begin + (sizeL / 4 + 1));
+                    std::iter_swap(begin + 2, begin + (sizeL / 4 + 2));
+                    std::iter_swap(pivotIt - 2, pivotIt - (sizeL / 4 + 1));
+                    std::iter_swap(pivotIt - 3, pivotIt - (sizeL / 4 + 2));
+                }
+            }
+
+            if (sizeR >= PDQ_INSERTION_THRESHOLD)
+            {
+                std::iter_swap(pivotIt + 1, pivotIt + (1 + sizeR / 4));
+                std::iter_swap(end - 1, end - sizeR / 4);
+
+                if (sizeR > NINTHER_THRESHOLD)
+                {
+                    std::iter_swap(pivotIt + 2, pivotIt + (2 + sizeR / 4));
+                    std::iter_swap(pivotIt + 3, pivotIt + (3 + sizeR / 4));
+                    std::iter_swap(end - 2, end - (1 + sizeR / 4));
+                    std::iter_swap(end - 3, end - (2 + sizeR / 4));
+                }
+            }
+        }
+        else if (alreadyPartitioned && partialInsertionSort(begin, pivotIt, cmp) && partialInsertionSort(pivotIt + 1, end, cmp))
+        {
+            // A balanced partition without any swaps suggests the range is nearly sorted.
+            return;
+        }
+
+        pdqSortLoop(begin, pivotIt, cmp, badAllowed, leftmost);
+        begin = pivotIt + 1;
+        leftmost = false;
+    }
+}
+
+} // namespace detail
+
+// Pattern-defeating quick sort. Partitioning is done BlockQuicksort style, comparing blocks of
+// elements against the pivot without branches, which avoids the mispredictions of a classic
+// partition on random data. Sorted and reverse sorted inputs are detected up front, nearly sorted
+// ranges are finished by insertion sort, and bad partitions trigger pattern breaking swaps
+// and eventually heap sort. Requires random access iterators.
+template <typename It, typename Compare = std::less<>>
+void pdqSort(It first, It last, Compare cmp = Compare{})
+{
+    if (last - first <= 1 || std::is_sorted(first, last, cmp))
+        return;
+
+    if (std::is_sorted(first, last, [&](const auto& lhs, const auto& rhs) { return cmp(rhs, lhs); }))
+        return std::reverse(first, last);
+
+    int badAllowed = 0;
+    for (auto size = last - first; size > 1; size /= 2)
+        ++badAllowed;
+
+    detail::pdqSortLoop(first, last, cmp, badAllowed, true);
+}
+
+namespace detail
+{
+// Minimum number of consecutive wins of one run before the merge switches to galloping.
+constexpr std::ptrdiff_t TIM_MIN_GALLOP = 7;
+
+// Exponential search from hint followed by binary search. Returns the number of elements
+// in [base, base + size) less than key (gallopLeft) or not greater than key (gallopRight).
+template <bool Right, typename T, typename It, typename Compare>
+auto gallop(const T& key, It base, std::ptrdiff_t size, std::ptrdiff_t hint, Compare cmp) -> std::ptrdiff_t
+{
+    // belongsLeft(element) means the key is inserted before the element.
+    auto belongsLeft = [&](const auto& element) { return Right ? cmp(key, element) : !cmp(element, key); };
+
+    std::ptrdiff_t lastOffset = 0;
+    std::ptrdiff_t offset = 1;
+
+    if (!belongsLeft(base[hint]))
+    {
+        const auto maxOffset = size - hint;
+        while (offset < maxOffset && !belongsLeft(base[hint + offset]))
+        {
+            lastOffset = offset;
+            offset = 2 * offset + 1;
+        }
+
+        offset = std::min(offset, maxOffset);
+        lastOffset += hint;
+        offset += hint;
+    }
+    else
+    {
+        const auto maxOffset = hint + 1;
+        while (offset < maxOffset && belongsLeft(base[hint - offset]))
+        {
+            lastOffset = offset;
+            offset = 2 * offset + 1;
+        }
+
+        offset = std::min(offset, maxOffset);
+        const auto tmp = lastOffset;
+        lastOffset = hint - offset;
+        offset = hint - tmp;
+    }
+
+    // The key belongs after base[lastOffset] and before or at base[offset].
+    const auto low = base + (lastOffset + 1);
+    const auto high = base + offset;
+    return (Right ? std::upper_bound(low, high, key, cmp) : std::lower_bound(low, high, key, cmp)) - base;
+}
+
+template <typename It, typename Compare>
+class TimSorter
+{
+public:
+    using ValueType = typename std::iterator_traits<It>::value_type;
+
+    TimSorter(std::vector<ValueType>& buffer, Compare cmp) : buffer_(buffer), cmp_(cmp) {}
+
+    void sort(It first, It last);
+
+private:
+    struct Run
+    {
+        It base;
+        std::ptrdiff_t size;
+    };
+
+    std::vector<ValueType>& buffer_;
+    std::vector<Run> runs_;
+    std::ptrdiff_t minGallop_ = TIM_MIN_GALLOP;
+    Compare cmp_;
+
+    static auto minRunSize(std::ptrdiff_t size) -> std::ptrdiff_t;
+    auto countRun(It first, It last) -> std::ptrdiff_t;
+    void binaryInsertionSort(It first, It last, It sortedEnd);
+    void mergeCollapse();
+    void mergeForceCollapse();
+    void mergeAt(std::size_t i);
+    void mergeLow(It base1, std::ptrdiff_t size1, It base2, std::ptrdiff_t size2);
+    void mergeHigh(It base1, std::ptrdiff_t size1, It base2, std::ptrdiff_t size2);
+};
+
+// Natural runs are extended to at least minRunSize by binary insertion sort and pushed on a
+// stack, which is merged whenever the run sizes stop decreasing like Fibonacci numbers.
+template <typename It, typename Compare>
+void TimSorter<It, Compare>::sort(It first, It last)
+{
+    auto remaining = last - first;
+    if (remaining < 2)
+        return;
+
+    const auto minRun = minRunSize(remaining);
+
+    while (remaining > 0)
+    {
+        auto size = countRun(first, last);
+
+        if (size < minRun)
+        {
+            const auto forced = std::min(remaining, minRun);
+            binaryInsertionSort(first, first + forced, first + size);
+            size = forced;
+        }
+
+        runs_.push_back({ first, size });
+        mergeCollapse();
+
+        first += size;
+        remaining -= size;
+    }
+
+    mergeForceCollapse();
+}
+
+// Take the six most significant bits of the size and add one if any of the rest is set,
+// so the size divided by the result is close to (but not above) a power of two.
+template <typename It, typename Compare>
+auto TimSorter<It, Compare>::minRunSize(std::ptrdiff_t size) -> std::ptrdiff_t
+{
+    std::ptrdiff_t rest = 0;
+    while (size >= 64)
+    {
+        rest |= size & 1;
+        size >>= 1;
+    }
+    return size + rest;
+}
+
+// Length of the run starting at first. A strictly descending run is reversed in place
+// (strictness keeps the sort stable).
+template <typename It, typename Compare>
+auto TimSorter<It, Compare>::countRun(It first, It last) -> std::ptrdiff_t
+{
+    auto runEnd = first + 1;
+    if (runEnd == last)
+        return 1;
+
+    if (cmp_(*runEnd, *first))
+    {
+        while (++runEnd != last && cmp_(*runEnd, *(runEnd - 1)));
+        std::reverse(first, runEnd);
+    }
+    else
+    {
+        while (++runEnd != last && !cmp_(*runEnd, *(runEnd - 1)));
+    }
+
+    return runEnd - first;
+}
+
+template <typename It, typename Compare>
+void TimSorter<It, Compare>::binaryInsertionSort(It first, It last, It sortedEnd)
+{
+    for (auto it = sortedEnd; it != last; ++it)
+    {
+        auto value = std::move(*it);
+        const auto pos = std::upper_bound(first, it, value, cmp_);
+        std::move_backward(pos, it, it + 1);
+        *pos = std::move(value);
+    }
+}
+
+// Keep the invariants size[n - 2] > size[n - 1] + size[n] and size[n - 1] > size[n] for the
+// top of the run stack (checked one level deeper as well, which fixes the original TimSort).
+template <typename It, typename Compare>
+void TimSorter<It, Compare>::mergeCollapse()
+{
+    while (runs_.size() > 1)
+    {
+        auto n = runs_.size() - 2;
+
+        if ((n > 0 && runs_[n - 1].size <= runs_[n].size + runs_[n + 1].size) ||
+            (n > 1 && runs_[n - 2].size <= runs_[n - 1].size + runs_[n].size))
+        {
+            if (runs_[n - 1].size < runs_[n + 1].size)
+                --n;
+            mergeAt(n);
+        }
+        else if (runs_[n].size <= runs_[n + 1].size)
+        {
+            mergeAt(n);
+        }
+        else
+            break;
+    }
+}
+
+template <typename It, typename Compare>
+void TimSorter<It, Compare>::mergeForceCollapse()
+{
+    while (runs_.size() > 1)
+    {
+        auto n = runs_.size() - 2;
+        if (n > 0 && runs_[n - 1].size < runs_[n + 1].size)
+            --n;
+        mergeAt(n);
+    }
+}
+
+// Merge runs i and i + 1. Elements of the first run not greater than the start of the second run
+// and elements of the second run not less than the end of the first run are already in place.
+template <typename It, typename Compare>
+void TimSorter<It, Compare>::mergeAt(std::size_t i)
+{
+    auto base1 = runs_[i].base;
+    auto size1 = runs_[i].size;
+    const auto base2 = runs_[i + 1].base;
+    auto size2 = runs_[i + 1].size;
+
+    runs_[i].size = size1 + size2;
+    runs_.erase(runs_.begin() + (i + 1));
+
+    const auto skipped = gallop<true>(*base2, base1, size1, 0, cmp_);
+    base1 += skipped;
+    size1 -= skipped;
+    if (size1 == 0)
+        return;
+
+    size2 = gallop<false>(*(base1 + (size1 - 1)), base2, size2, size2 - 1, cmp_);
+    if (size2 == 0)
+        return;
+
+    if (buffer_.size() < static_cast<std::size_t>(std::min(size1, size2)))
+        buffer_.resize(std::min(size1, size2));
+
+    if (size1 <= size2)
+        mergeLow(base1, size1, base2, size2);
+    else
+        mergeHigh(base1, size1, base2, size2);
+}
+
+// Merge from the front with the first (smaller) run moved to the buffer. Once one run wins
+// minGallop times in a row, the merge gallops: whole blocks are located by exponential search
+// and moved at once. The threshold adapts to how well galloping pays off.
+template <typename It, typename Compare>
+void TimSorter<It, Compare>::mergeLow(It base1, std::ptrdiff_t size1, It base2, std::ptrdiff_t size2)
+{
+    auto cursor1 = buffer_.begin();
+    const auto end1 = std::move(base1, base1 + size1, cursor1);
+    auto cursor2 = base2;
+    const auto end2 = base2 + size2;
+    auto dest = base1;
+
+    while (cursor1 != end1 && cursor2 != end2)
+    {
+        std::ptrdiff_t wins1 = 0;
+        std::ptrdiff_t wins2 = 0;
+
+        while (cursor1 != end1 && cursor2 != end2 && wins1 < minGallop_ && wins2 < minGallop_)
+        {
+            if (cmp_(*cursor2, *cursor1))
+            {
+                *dest++ = std::move(*cursor2++);
+                ++wins2;
+                wins1 = 0;
+            }
+            else
+            {
+                *dest++ = std::move(*cursor1++);
+                ++wins1;
+                wins2 = 0;
+            }
+        }
+
+        while (cursor1 != end1 && cursor2 != end2)
+        {
+            wins1 = gallop<true>(*cursor2, cursor1, end1 - cursor1, 0, cmp_);
+            dest = std::move(cursor1, cursor1 + wins1, dest);
+            cursor1 += wins1;
+            if (cursor1 == end1)
+                break;
+
+            wins2 = gallop<false>(*cursor1, cursor2, end2 - cursor2, 0, cmp_);
+            dest = std::move(cursor2, cursor2 + wins2, dest);
+            cursor2 += wins2;
+
+            if (wins1 < TIM_MIN_GALLOP && wins2 < TIM_MIN_GALLOP)
+            {
+                minGallop_ += 2;
+                break;
+            }
+
+            minGallop_ = std::max<std::ptrdiff_t>(minGallop_ - 1, 1);
+        }
+    }
+
+    std::move(cursor1, end1, dest);
+}
+
+// Mirror of mergeLow merging from the back with the second (smaller) run moved to the buffer.
+template <typename It, typename Compare>
+void TimSorter<It, Compare>::mergeHigh(It base1, std::ptrdiff_t size1, It base2, std::ptrdiff_t size2)
+{
+    const auto begin1 = base1;
+    auto cursor1 = base1 + size1;
+    const auto begin2 = buffer_.begin();
+    auto cursor2 = std::move(base2, base2 + size2, begin2);
+    auto dest = base2 + size2;
+
+    while (cursor1 != begin1 && cursor2 != begin2)
+    {
+        std::ptrdiff_t wins1 = 0;
+        std::ptrdiff_t wins2 = 0;
+
+        while (cursor1 != begin1 && cursor2 != begin2 && wins1 < minGallop_ && wins2 < minGallop_)
+        {
+            if (cmp_(*(cursor2 - 1), *(cursor1 - 1)))
+            {
+                *--dest = std::move(*--cursor1);
+                ++wins1;
+                wins2 = 0;
+            }
+            else
+            {
+                *--dest = std::move(*--cursor2);
+                ++wins2;
+                wins1 = 0;
+            }
+        }
+
+        while (cursor1 != begin1 && cursor2 != begin2)
+        {
+            const auto size1Left = cursor1 - begin1;
+            wins1 = size1Left - gallop<true>(*(cursor2 - 1), begin1, size1Left, size1Left - 1, cmp_);
+            dest = std::move_backward(cursor1 - wins1, cursor1, dest);
+            cursor1 -= wins1;
+            if (cursor1 == begin1)
+                break;
+
+            const auto size2Left = cursor2 - begin2;
+            wins2 = size2Left - gallop<false>(*(cursor1 - 1), begin2, size2Left, size2Left - 1, cmp_);
+            dest = std::move_backward(cursor2 - wins2, cursor2, dest);
+            cursor2 -= wins2;
+
+            if (wins1 < TIM_MIN_GALLOP && wins2 < TIM_MIN_GALLOP)
+            {
+                minGallop_ += 2;
+                break;
+            }
+
+            minGallop_ = std::max<std::ptrdiff_t>(minGallop_ - 1, 1);
+        }
+    }
+
+    std::move_backward(begin2, cursor2, dest);
+}
+
+} // namespace detail
+
+// Stable natural merge sort. Existing ascending and strictly descending runs are detected and
+// short runs are extended by binary insertion sort, so nearly sorted input is sorted in close to
+// linear time. Merges gallop when one run keeps winning. The merge buffer is passed by the caller
+// and only grows, so it can be reused between sorts. Requires random access iterators.
+template <typename It, typename Compare = std::less<>>
+void timSort(It first, It last, std::vector<typename std::iterator_traits<It>::value_type>& buffer, Compare cmp = Compare{})
+{
+    detail::TimSorter<It, Compare>(buffer, cmp).sort(first, last);
+}
+
+template <typename It, typename Compare = std::less<>>
+void timSort(It first, It last, Compare cmp = Compare{})
+{
+    std::vector<typename std::iterator_traits<It>::value_type> buffer;
+    timSort(first, last, buffer, cmp);
+}
+
 } // namespace sort
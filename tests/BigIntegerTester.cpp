@@ -1,6 +1,8 @@
 #include <cassert>
 #include <cmath>
 #include <iostream>
+#include <limits>
+#include <string>
 
 #include "../math/BigInteger.hpp"
 
@@ -21,6 +23,11 @@ public:
         pairTest(5, 0, print);
         pairTest(0, 5, print);
         pairTest(0, 0, print);
+        limbTest();
+        largeMultiplicationTest();
+        largeDivisionTest();
+        conversionTest();
+        numberTheoryTest();
 
         std::cout << "Passed all tests" << std::endl;
     }
@@ -83,6 +90,92 @@ public:
 
         std::cout << "Passed (" << x << ", " << y << ")" << std::endl;
     }
+
+    void limbTest() const
+    {
+        const auto lowest = std::numeric_limits<long long>::min();
+        const BigInteger minimum(lowest);
+        const BigInteger limbMax("4294967295");
+        const BigInteger twoLimbMax("18446744073709551615");
+
+        assert(minimum.print() == "-9223372036854775808" && minimum.compare(lowest) && !minimum.compare(lowest + 1) && "Lowest value error");
+        assert(minimum - 1 + 1 == minimum && (minimum * -1).print() == "9223372036854775808" && "Lowest value arithmetic error");
+        assert((limbMax + 1).print() == "4294967296" && limbMax + 1 - 1 == limbMax && "Limb carry error");
+        assert(((BigInteger(2) ^ 64) - 1) == twoLimbMax && (twoLimbMax + 1).print() == "18446744073709551616" && "Carry across limbs error");
+        assert((BigInteger(2) ^ 64) - twoLimbMax == 1 && BigInteger(1) - (BigInteger(2) ^ 64) == BigInteger(0) - twoLimbMax && "Borrow across limbs error");
+        assert(limbMax * limbMax == twoLimbMax - limbMax * 2 && twoLimbMax / limbMax == BigInteger("4294967297") && "Limb product error");
+        std::cout << "Passed limb boundaries" << std::endl;
+    }
+
+    void largeMultiplicationTest() const
+    {
+        const auto nines = power10(3000) - 1; // Toom-3
+        const auto shortNines = power10(500) - 1; // Karatsuba, unbalanced
+        BigInteger factorial(1);
+        for (int i = 2; i <= 1000; ++i)
+            factorial *= i;
+
+        assert(nines * nines == power10(6000) - power10(3000) * 2 + 1 && "Large multiplication error");
+        assert(nines * (BigInteger(0) - shortNines) == power10(3000) + power10(500) - power10(3500) - 1 && "Unbalanced multiplication error");
+        assert(factorial.digitCnt() == 2568 && factorial.digitSum() == 10539 && "Factorial error");
+        std::cout << "Passed large multiplication" << std::endl;
+    }
+
+    void largeDivisionTest() const
+    {
+        const auto nines = power10(3000) - 1;
+        const auto dividend = nines * nines + 12345; // Burnikel-Ziegler
+        const auto [quotient, remainder] = dividend.divmod(nines);
+        const auto [smallQuotient, smallRemainder] = BigInteger(-7).divmod(2);
+
+        assert(quotient == nines && remainder == 12345 && "Large division error");
+        assert(dividend / (power10(40) + 1) * (power10(40) + 1) + dividend % (power10(40) + 1) == dividend && "Division error");
+        assert(smallQuotient == -3 && smallRemainder == -1 && "Divmod sign error");
+        std::cout << "Passed large division" << std::endl;
+    }
+
+    void conversionTest() const
+    {
+        std::string digits;
+        for (int i = 0; i < 20000; ++i)
+            digits += static_cast<char>('0' + (i * 7 + 1) % 10);
+
+        const BigInteger large("-" + digits);
+        const BigInteger hex("-DeadBeef0123456789abcdef", 16);
+
+        assert(large.print() == "-" + digits && large.digitCnt() == 20000 && "Decimal conversion error");
+        assert(BigInteger(large.toString(36), 36) == large && BigInteger(large.toString(2), 2) == large && "Base conversion error");
+        assert(hex.toString(16) == "-deadbeef0123456789abcdef" && BigInteger(255).toString(2) == "11111111" && "Hexadecimal conversion error");
+        assert(BigInteger("zz", 36) == 1295 && BigInteger(0).toString(7) == "0" && "Base conversion error");
+        std::cout << "Passed conversion" << std::endl;
+    }
+
+    void numberTheoryTest() const
+    {
+        const auto mersenne = (BigInteger(2) ^ 521) - 1;
+        const auto composite = mersenne * ((BigInteger(2) ^ 607) - 1);
+        const auto base = power10(150) + 7;
+
+        assert(BigInteger::powMod(3, 1000, 1000007) == 297623 && BigInteger::powMod(-3, 5, 10) == 7 && "Modular power error");
+        assert(BigInteger::powMod(base, mersenne - 1, mersenne) == 1 && "Montgomery power error");
+        assert(BigInteger::powMod(base, 12345, power10(40)) == (base ^ 12345) % power10(40) && "Even modulus power error");
+        assert(BigInteger::gcd(power10(60) * 21, power10(50) * -35) == power10(50) * 35 && "Gcd error");
+        assert(BigInteger::modInverse(base, mersenne) * base % mersenne == 1 && "Modular inverse error");
+        assert(mersenne.isProbablePrime() && !composite.isProbablePrime() && !BigInteger(561).isProbablePrime() && "Primality error");
+
+        // Strong pseudoprimes to the prime bases up to 37 and up to 41: the first is below the limit
+        // of the exact test, the second only fails random bases.
+        assert(!BigInteger("318665857834031151167461").isProbablePrime() && "Deterministic primality error");
+        assert(!BigInteger("3317044064679887385961981").isProbablePrime() && "Random base primality error");
+        assert(((BigInteger(2) ^ 61) - 1).isProbablePrime() && ((BigInteger(2) ^ 89) - 1).isProbablePrime() && "Primality error");
+        std::cout << "Passed number theory" << std::endl;
+    }
+
+private:
+    static auto power10(std::size_t exponent) -> BigInteger
+    {
+        return BigInteger("1" + std::string(exponent, '0'));
+    }
 };
 
 int main()
@@ -0,0 +1,94 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../linear/ConcurrentHashTable.hpp"
+
+class ConcurrentHashTableTester
+{
+public:
+    void fullTest() const
+    {
+        singleThreadTest();
+        multiThreadTest();
+
+        std::cout << "Passed all tests" << std::endl;
+    }
+
+    void singleThreadTest() const
+    {
+        ConcurrentHashTable<int> table(64, 5);
+        assert(table.stripeCnt() == 8 && "Stripe count error");
+
+        for (int value = 0; value < 1000; ++value)
+            table.insert(value);
+        table.insert(7);
+
+        for (int value = 0; value < 1000; value += 2)
+            table.remove(value);
+
+        assert(table.size() == 500 && "Size error");
+        for (int value = 0; value < 1000; ++value)
+            assert(table.contains(value) == (value % 2 == 1) && "Contains error");
+
+        table.reserve(10000);
+        assert(table.size() == 500 && table.contains(999) && "Reserve error");
+        assert(table.print().find("stripe 7\n") != std::string::npos && "Print error");
+
+        std::cout << "Passed single thread" << std::endl;
+    }
+
+    // Each thread owns the values equal to its index modulo the thread count, so the final contents
+    // are known, while the stripes (and their migrations) are shared by all threads. Readers check
+    // values no writer touches. Meant to be run under -fsanitize=thread as well.
+    void multiThreadTest() const
+    {
+        constexpr int THREADS = 4;
+        constexpr int VALUES = 20000;
+        ConcurrentHashTable<int> table(16, 4);
+        std::vector<std::thread> threads;
+
+        for (int value = VALUES; value < VALUES + 1000; ++value)
+            table.insert(value);
+
+        for (int t = 0; t < THREADS; ++t)
+        {
+            threads.emplace_back([&table, t]() {
+                for (int value = t; value < VALUES; value += THREADS)
+                {
+                    table.insert(value);
+                    assert(table.contains(value) && "Concurrent insert error");
+                }
+
+                for (int value = t; value < VALUES; value += 2 * THREADS)
+                    table.remove(value);
+            });
+
+            threads.emplace_back([&table]() {
+                for (int round = 0; round < 5; ++round)
+                {
+                    for (int value = VALUES; value < VALUES + 1000; ++value)
+                        assert(table.contains(value) && "Concurrent lookup error");
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+
+        assert(table.size() == VALUES / 2 + 1000 && "Concurrent size error");
+        for (int value = 0; value < VALUES; ++value)
+            assert(table.contains(value) == (value % (2 * THREADS) >= THREADS) && "Concurrent contents error");
+
+        std::cout << "Passed multiple threads" << std::endl;
+    }
+};
+
+int main()
+{
+    ConcurrentHashTableTester().fullTest();
+
+    return 0;
+}
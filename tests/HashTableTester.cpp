@@ -0,0 +1,239 @@
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <utility>
+
+#include "../linear/HashTable.hpp"
+
+// Maps all values to a few hashes, so they share the 7 bits in the control words and the probes.
+struct CollidingHash
+{
+    auto operator()(int value) const -> std::size_t { return static_cast<std::size_t>(value % 4); }
+};
+
+class HashTableTester
+{
+public:
+    void fullTest() const
+    {
+        referenceTest();
+        duplicateTest();
+        collisionTest();
+        copyTest();
+        printTest();
+        migrationTest();
+        deletedRebuildTest();
+        rehashDuringMigrationTest();
+
+        std::cout << "Passed all tests" << std::endl;
+    }
+
+    // Random inserts and removes across several growths compared with std::unordered_set.
+    void referenceTest() const
+    {
+        HashTable<int> table(16);
+        std::unordered_set<int> reference;
+        std::mt19937 rng(1);
+
+        for (int i = 0; i < 20000; ++i)
+        {
+            const auto value = static_cast<int>(rng() % 5000);
+
+            if (rng() % 3 == 0)
+            {
+                table.remove(value);
+                reference.erase(value);
+            }
+            else
+            {
+                table.insert(value);
+                reference.insert(value);
+            }
+
+            assert(table.size() == reference.size() && "Size error");
+        }
+
+        for (int value = 0; value < 5000; ++value)
+            assert(table.contains(value) == (reference.count(value) != 0) && "Contains error");
+
+        assert(table.loadFactor() <= table.maxLoadFactor() && "Load factor error");
+        std::cout << "Passed reference set" << std::endl;
+    }
+
+    void duplicateTest() const
+    {
+        HashTable<std::string> table(16);
+
+        table.insert("a");
+        table.insert("a");
+        table.insert("b");
+        assert(table.size() == 2 && "Duplicate insert error");
+
+        table.remove("a");
+        table.remove("a");
+        table.remove("c");
+        assert(table.size() == 1 && !table.contains("a") && table.contains("b") && "Duplicate remove error");
+
+        std::cout << "Passed duplicates" << std::endl;
+    }
+
+    // Every value has the same control word as a quarter of the others, so each group match returns
+    // many candidates. Removing from full groups leaves deleted slots, which probes must walk past
+    // and inserts must reuse.
+    void collisionTest() const
+    {
+        HashTable<int, CollidingHash> table(256);
+
+        for (int value = 0; value < 200; ++value)
+            table.insert(value);
+
+        for (int value = 0; value < 200; value += 2)
+            table.remove(value);
+
+        for (int value = 0; value < 200; ++value)
+            assert(table.contains(value) == (value % 2 == 1) && "Deleted slot error");
+
+        const auto capacity = table.capacity();
+        for (int value = 0; value < 200; value += 2)
+            table.insert(value);
+
+        for (int value = 0; value < 200; ++value)
+            assert(table.contains(value) && "Deleted slot reuse error");
+        assert(table.size() == 200 && table.capacity() == capacity && "Deleted slot reuse error");
+
+        std::cout << "Passed collisions" << std::endl;
+    }
+
+    // Slots are raw memory from operator new, so the values need deep copies and exactly one
+    // destruction (checked by the sanitizers).
+    void copyTest() const
+    {
+        HashTable<std::string> table(16);
+        for (int i = 0; i < 100; ++i)
+            table.insert(std::string(40, static_cast<char>('a' + i % 26)) + std::to_string(i));
+
+        HashTable<std::string> copy(table);
+        table.remove(std::string(40, 'a') + "0");
+        assert(copy.size() == 100 && table.size() == 99 && copy.contains(std::string(40, 'a') + "0") && "Copy error");
+
+        HashTable<std::string> assigned(16);
+        assigned.insert("x");
+        assigned = copy;
+        assert(assigned.size() == 100 && !assigned.contains("x") && "Copy assignment error");
+
+        HashTable<std::string> moved(std::move(assigned));
+        assert(moved.size() == 100 && moved.contains(std::string(40, 'z') + "25") && "Move error");
+
+        copy = std::move(moved);
+        assert(copy.size() == 100 && copy.contains(std::string(40, 'b') + "1") && "Move assignment error");
+
+        std::cout << "Passed copies" << std::endl;
+    }
+
+    void printTest() const
+    {
+        HashTable<int> table(16);
+        table.insert(5);
+        table.insert(42);
+
+        const auto printed = table.print();
+        std::size_t lines = 0;
+        for (char c : printed)
+            lines += c == '\n';
+
+        assert(lines == table.capacity() && "Print error");
+        assert(printed.find(": 5\n") != std::string::npos && printed.find(": 42\n") != std::string::npos && "Print error");
+
+        std::cout << "Passed print" << std::endl;
+    }
+
+    // Fill a table up to the point where the next insert starts a migration.
+    template <typename Table>
+    void startMigration(Table& table, int count) const
+    {
+        for (int value = 0; value < count; ++value)
+            table.insert(value);
+
+        assert(table.isRehashing() && "Migration start error");
+    }
+
+    // Values are spread over both tables while the migration runs, lookups and removes must see both.
+    void migrationTest() const
+    {
+        HashTable<int> table(1024);
+        startMigration(table, 897);
+
+        for (int value = 0; value < 897; ++value)
+            assert(table.contains(value) && "Lookup during migration error");
+
+        int removed = 0;
+        for (int value = 0; table.isRehashing(); value += 3, ++removed)
+        {
+            table.remove(value);
+            assert(!table.contains(value) && table.size() == 897u - removed - 1 && "Remove during migration error");
+        }
+
+        for (int value = 0; value < 897; ++value)
+            assert(table.contains(value) == (value % 3 != 0 || value >= 3 * removed) && "Migration error");
+
+        assert(table.capacity() == 2048 && "Migration capacity error");
+        std::cout << "Passed migration" << std::endl;
+    }
+
+    // When most of the used slots are deleted ones, growing rebuilds the table with the same capacity.
+    void deletedRebuildTest() const
+    {
+        HashTable<int, CollidingHash> table(1024);
+
+        for (int value = 0; value < 896; ++value)
+            table.insert(value);
+
+        for (int value = 0; value < 800; ++value)
+            table.remove(value);
+
+        assert(!table.isRehashing() && table.capacity() == 1024 && "Deleted rebuild setup error");
+
+        table.setMaxLoadFactor(0.5f);
+        assert(table.isRehashing() && table.capacity() == 1024 && "Deleted rebuild error");
+
+        for (int value = 0; value < 896; ++value)
+            assert(table.contains(value) == (value >= 800) && "Deleted rebuild lookup error");
+
+        // A rehash to no particular size shrinks the table to what the values need.
+        table.rehash(0);
+        assert(!table.isRehashing() && table.size() == 96 && table.capacity() == 256 && "Deleted rebuild rehash error");
+
+        std::cout << "Passed deleted rebuild" << std::endl;
+    }
+
+    // Explicit rehash and reserve finish the running migration before they rebuild the table.
+    void rehashDuringMigrationTest() const
+    {
+        HashTable<int> table(1024);
+        startMigration(table, 897);
+
+        table.reserve(5000);
+        assert(!table.isRehashing() && table.capacity() >= 5000 / table.maxLoadFactor() && "Reserve during migration error");
+
+        for (int value = 897; table.capacity() < 8192 || !table.isRehashing(); ++value)
+            table.insert(value);
+
+        const auto size = table.size();
+        table.rehash(64);
+        assert(!table.isRehashing() && table.size() == size && table.capacity() == 16384 && "Rehash during migration error");
+
+        for (int value = 0; value < static_cast<int>(size); ++value)
+            assert(table.contains(value) && "Rehash during migration error");
+
+        std::cout << "Passed rehash during migration" << std::endl;
+    }
+};
+
+int main()
+{
+    HashTableTester().fullTest();
+
+    return 0;
+}
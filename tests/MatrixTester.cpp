@@ -1,6 +1,11 @@
 #include <cassert>
+#include <cmath>
 #include <iostream>
+#include <random>
+#include <stdexcept>
+#include <tuple>
 
+#include "../math/FixedMatrix.hpp"
 #include "../math/Matrix.hpp"
 
 class MatrixTester
@@ -11,12 +16,18 @@ public:
         additionTest();
         subtractionTest();
         multiplicationTest();
+        largeMultiplicationTest();
+        expressionTest();
+        fixedMatrixTest();
         transposeTest();
         determinantTest();
+        singularTest();
         inverseTest();
+        rankTest();
         rowEchelonFormTest();
         reducedRowEchelonFormTest();
         linSolveTest();
+        largeLinSolveTest();
 
         std::cout << "Passed all tests" << std::endl;
     }
@@ -57,6 +68,119 @@ public:
         std::cout << "Passed multiplication" << std::endl;
     }
 
+    // Sizes that are not multiples of the blocking of the product.
+    void largeMultiplicationTest() const
+    {
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<double> dist(-1, 1);
+
+        for (auto [m, k, n] : { std::make_tuple(50, 37, 41), std::make_tuple(103, 300, 131), std::make_tuple(7, 600, 2100) })
+        {
+            Matrix a(m, k);
+            Matrix b(k, n);
+            Matrix expected(m, n);
+
+            for (int i = 0; i < m; ++i)
+            {
+                for (int p = 0; p < k; ++p)
+                    a[i][p] = dist(rng);
+            }
+
+            for (int p = 0; p < k; ++p)
+            {
+                for (int j = 0; j < n; ++j)
+                    b[p][j] = dist(rng);
+            }
+
+            for (int i = 0; i < m; ++i)
+            {
+                for (int p = 0; p < k; ++p)
+                {
+                    for (int j = 0; j < n; ++j)
+                        expected[i][j] += a[i][p] * b[p][j];
+                }
+            }
+
+            auto result = a * b;
+
+            assert(result == expected && "Large multiplication error");
+        }
+
+        std::cout << "Passed large multiplication" << std::endl;
+    }
+
+    void expressionTest() const
+    {
+        Matrix a = { { 1, 2 }, { 3, 4 } };
+        Matrix b = { { 0, 1 }, { 1, 0 } };
+        Matrix c = { { 2, 2 }, { 2, 2 } };
+
+        Matrix fused = a + b - c * 2;
+        assert(fused == Matrix({ { -3, -1 }, { 0, 0 } }) && "Fused expression error");
+        assert(-a / 2 + 0.5 * a == Matrix(2, 2) && "Scalar expression error");
+
+        Matrix mixed = a * b + c;
+        assert(mixed == Matrix({ { 4, 3 }, { 6, 5 } }) && "Product in expression error");
+        assert((a + b) * c == Matrix({ { 8, 8 }, { 16, 16 } }) && "Expression in product error");
+
+        Matrix aliased = a;
+        aliased = aliased * b;
+        assert(aliased == Matrix({ { 2, 1 }, { 4, 3 } }) && "Aliased product error");
+
+        aliased += a * 2 - b;
+        assert(aliased == Matrix({ { 4, 4 }, { 9, 11 } }) && "Compound expression error");
+
+        Matrix result(5, 5);
+        result.noalias() = a * b;
+        assert(result == Matrix({ { 2, 1 }, { 4, 3 } }) && "No alias product error");
+
+        auto product = a * b;
+        assert(product.inverse() == Matrix({ { 1.5, -0.5 }, { -2, 1 } }) && "Expression inverse error");
+        assert((a * b).determinant() == 2 && (a + b).print() == "1 3\n4 4\n" && "Expression Matrix API error");
+
+        auto owned = a * 2 + Matrix({ { 1, 1 }, { 1, 1 } }) * b.transpose();
+        assert(owned == Matrix({ { 3, 5 }, { 7, 9 } }) && "Temporary in expression error");
+
+        bool thrown = false;
+        try
+        {
+            Matrix invalid = a + Matrix(3, 2);
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        assert(thrown && "Expression dimensions error");
+
+        std::cout << "Passed expressions" << std::endl;
+    }
+
+    void fixedMatrixTest() const
+    {
+        constexpr Matrix3 a = { { 1, 2, 0 }, { 0, 1, 0 }, { 3, 0, 1 } };
+        constexpr FixedMatrix<3, 2> b = { { 1, 0 }, { 0, 1 }, { 2, 2 } };
+        constexpr auto product = a * b;
+        constexpr auto sum = Matrix3::identity() * 2 - a;
+
+        static_assert(product == FixedMatrix<3, 2>({ { 1, 2 }, { 0, 1 }, { 5, 2 } }), "Fixed multiplication error");
+        static_assert(sum == Matrix3({ { 1, -2, 0 }, { 0, 1, 0 }, { -3, 0, 1 } }), "Fixed arithmetic error");
+        static_assert(a.transpose().transpose() == a && a.trace() == 3, "Fixed transpose error");
+        static_assert(a.determinant() == 1 && Matrix4::identity().determinant() == 1, "Fixed determinant error");
+
+        Matrix dynamic = b;
+        Matrix mixed = a * dynamic + b;
+        assert(mixed == Matrix({ { 2, 2 }, { 0, 2 }, { 7, 4 } }) && "Fixed to dynamic error");
+        assert((FixedMatrix<3, 2>(mixed - b) == product) && "Dynamic to fixed error");
+        static_assert(Matrix3::identity() + 1 - 1 == Matrix3::identity(), "Fixed scalar error");
+
+        Matrix square = { { 0, 1, 0 }, { 1, 0, 0 }, { 0, 0, 2 } };
+        const Matrix3 swapped = { { 2, 1, 0 }, { 1, 0, 0 }, { 0, 3, 2 } };
+        assert((FixedMatrix<3, 3>(a * square) == swapped) && "Fixed times dynamic error");
+        assert((Matrix3(square * square) == Matrix3({ { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 4 } })) && "Dynamic product to fixed error");
+
+        std::cout << "Passed fixed matrix" << std::endl;
+    }
+
     void transposeTest() const
     {
         Matrix m = { { 6, 4, 24 }, { 1, -9, 8 } };
@@ -65,6 +189,23 @@ public:
         auto result = m.transpose();
 
         assert(result == expected && "Transpose error");
+
+        Matrix tall(150, 37);
+        Matrix square(150, 150);
+        for (std::size_t i = 0; i < 150; ++i)
+        {
+            for (std::size_t j = 0; j < 150; ++j)
+                square[i][j] = static_cast<double>(i * 150 + j);
+            for (std::size_t j = 0; j < 37; ++j)
+                tall[i][j] = static_cast<double>(i * 37 + j);
+        }
+
+        auto wide = tall.transpose();
+        auto inPlace = square;
+        inPlace.transposeInPlace();
+
+        assert(wide.getRowCnt() == 37 && wide[36][149] == 149 * 37 + 36 && wide.transpose() == tall && "Large transpose error");
+        assert(inPlace == square.transpose() && inPlace[37][148] == 148 * 150 + 37 && "In-place transpose error");
         std::cout << "Passed transpose" << std::endl;
     }
 
@@ -78,9 +219,55 @@ public:
         double d2 = -306;
         assert(m2.determinant() == d2 && "Determinant 3x3 error");
 
+        Matrix m3 = { { 0, 2, 1, 4 }, { 3, 0, 0, 1 }, { 1, 1, 0, 0 }, { 0, 0, 2, 5 } };
+        double d3 = -13;
+        assert(std::abs(m3.determinant() - d3) < 1e-9 && "Determinant 4x4 error");
+
+        Matrix m4 = { { 1, 2, 3, 4 }, { 2, 4, 6, 8 }, { 0, 1, 0, 1 }, { 5, 0, 1, 1 } };
+        assert(m4.determinant() == 0 && m4.isSingular() && "Determinant singular error");
+
+        std::mt19937 rng(2);
+        std::uniform_real_distribution<double> dist(0.5, 2);
+        Matrix m5(200, 200);
+        double d5 = 1;
+
+        for (std::size_t i = 0; i < 200; ++i) // det(L * U) = product of diagonal of U
+        {
+            for (std::size_t j = 0; j < 200; ++j)
+                m5[i][j] = i <= j ? dist(rng) : 0;
+            d5 *= m5[i][i];
+        }
+
+        Matrix lower(200, 200);
+        lower.makeIdentity();
+        for (std::size_t i = 1; i < 200; ++i)
+            lower[i][i - 1] = 0.5;
+
+        assert(std::abs((lower * m5).determinant() / d5 - 1) < 1e-9 && "Determinant 200x200 error");
+
         std::cout << "Passed determinant" << std::endl;
     }
 
+    // Singularity is decided by LU with a pivot tolerance relative to the largest element, so
+    // rounding noise does not make a singular matrix regular, and scale alone does not make a regular
+    // matrix singular.
+    void singularTest() const
+    {
+        const double noise = std::nextafter(4.0, 5.0) - 4;
+        Matrix nearlySingular = { { 1, 2, 3, 4 }, { 2, 4, 6 + noise, 8 }, { 0, 1, 1, 0 }, { 1, 0, 0, 1 } };
+        assert(nearlySingular.isSingular() && nearlySingular.determinant() == 0 && "Nearly singular error");
+        assert(nearlySingular.rank() == 3 && "Nearly singular rank error");
+
+        Matrix small = { { 1e-20, 0, 0, 0 }, { 0, 2e-20, 0, 0 }, { 1e-20, 0, 3e-20, 0 }, { 0, 0, 0, 1e-20 } };
+        assert(!small.isSingular() && std::abs(small.determinant() / 6e-80 - 1) < 1e-12 && "Small regular error");
+
+        Matrix conditioned = { { 4, 1, 0 }, { 1, 4, 1 }, { 0, 1, 4 } };
+        assert(!conditioned.isSingular() && std::abs(conditioned.determinant() - 56) < 1e-9 && "Regular error");
+        assert(!Matrix(2, 3).isSingular() && "Non-square singular error");
+
+        std::cout << "Passed singular" << std::endl;
+    }
+
     void inverseTest() const
     {
         Matrix m = { { 1, 2 }, { 3, 9 } };
@@ -92,6 +279,28 @@ public:
         std::cout << "Passed inverse" << std::endl;
     }
 
+    void rankTest() const
+    {
+        Matrix m1 = { { 0, 1, 0 }, { 0, 0, 1 }, { 0, 0, 0 } };
+        assert(m1.rank() == 2 && "Rank (skipped column) error");
+
+        Matrix m2 = { { 1, 2, 3 }, { 2, 4, 6 }, { 1, 0, 1 }, { 3, 4, 7 } };
+        assert(m2.rank() == 2 && "Rank (dependent rows) error");
+
+        Matrix m3(3, 5);
+        assert(m3.rank() == 0 && "Rank (zero) error");
+
+        Matrix m4(150, 90);
+        for (std::size_t i = 0; i < 150; ++i) // sum of two outer products
+        {
+            for (std::size_t j = 0; j < 90; ++j)
+                m4[i][j] = std::sin(i + 1.0) * std::cos(j + 2.0) + (i % 7) * (j % 5 + 0.5);
+        }
+        assert(m4.rank() == 2 && "Rank (large) error");
+
+        std::cout << "Passed rank" << std::endl;
+    }
+
     void rowEchelonFormTest() const
     {
         Matrix m = { { 1, 1, 2 }, { 1, 2, 3 }, { 3, 4, 5 } };
@@ -127,6 +336,33 @@ public:
         assert(result == expected && "Linear solve error");
         std::cout << "Passed linear solve" << std::endl;
     }
+
+    void largeLinSolveTest() const
+    {
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<double> dist(-1, 1);
+        const std::size_t n = 300;
+
+        Matrix a(n, n);
+        Matrix x(n, 3);
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            for (std::size_t j = 0; j < n; ++j)
+                a[i][j] = dist(rng);
+            for (std::size_t j = 0; j < 3; ++j)
+                x[i][j] = dist(rng);
+        }
+
+        auto result = Matrix::linSolve(a, a * x);
+        assert(result == x && "Large linear solve error");
+
+        Matrix identity(n, n);
+        identity.makeIdentity();
+        assert(a * a.inverse() == identity && "Large inverse error");
+
+        std::cout << "Passed large linear solve" << std::endl;
+    }
 };
 
 int main()
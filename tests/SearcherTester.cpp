@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "../sequence/EytzingerIndex.hpp"
+#include "../sequence/Searcher.hpp"
+
+namespace search
+{
+class SearcherTester
+{
+public:
+    void fullTest() const
+    {
+        extremeTest<int>();
+        extremeTest<float>();
+        extremeTest<double>();
+        linearSearchTest<int>();
+        linearSearchTest<long long>();
+        linearSearchTest<std::int64_t>();
+        linearSearchTest<double>();
+        binarySearchTest();
+        eytzingerTest();
+        batchSearchTest();
+        interpolationSearchTest<int>();
+        interpolationSearchTest<long long>();
+        interpolationSearchTest<double>();
+
+        std::cout << "Passed all tests" << std::endl;
+    }
+
+    // Compare the default comparator (vector kernels) with an equivalent custom one (scalar loop).
+    template <typename T>
+    void extremeTest() const
+    {
+        std::mt19937 rng(1);
+
+        for (int size = 0; size < 300; ++size)
+        {
+            std::vector<T> data(size);
+            std::generate(data.begin(), data.end(), [&]() { return static_cast<T>(static_cast<int>(rng() % 100) - 50); });
+
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                if (size > 0 && size % 5 == 0)
+                    data[rng() % size] = NAN;
+            }
+
+            const auto minIt = findMinimum(data.begin(), data.end(), [](T a, T b) { return a < b; });
+            const auto maxIt = findMaximum(data.begin(), data.end(), [](T a, T b) { return a > b; });
+
+            assert(findMinimum(data.begin(), data.end()) == minIt && "Minimum error");
+            assert(findMaximum(data.begin(), data.end()) == maxIt && "Maximum error");
+        }
+
+        std::cout << "Passed extreme search" << std::endl;
+    }
+
+    template <typename T>
+    void linearSearchTest() const
+    {
+#ifdef SEARCH_SIMD_X86
+        static_assert(!std::is_integral_v<T> || search::detail::hasFindKernel<typename std::vector<T>::iterator, T, std::equal_to<>>(),
+            "Signed 32 and 64-bit integers must use the vector kernel");
+#endif
+        std::mt19937 rng(2);
+
+        for (int size = 0; size < 300; ++size)
+        {
+            std::vector<T> data(size);
+            std::generate(data.begin(), data.end(), [&]() { return static_cast<T>(rng() % 100); });
+
+            const auto value = static_cast<T>(rng() % 120);
+            assert(linearSearch(data.begin(), data.end(), value) == std::find(data.begin(), data.end(), value) && "Linear search error");
+        }
+
+        std::cout << "Passed linear search" << std::endl;
+    }
+
+    void binarySearchTest() const
+    {
+        std::mt19937 rng(3);
+
+        for (int size = 0; size < 300; ++size)
+        {
+            std::vector<int> data(size);
+            std::generate(data.begin(), data.end(), [&]() { return static_cast<int>(rng() % 200); });
+            std::sort(data.begin(), data.end());
+
+            for (int value = -1; value <= 200; value += 3)
+            {
+                const auto expected = std::lower_bound(data.begin(), data.end(), value);
+                assert(branchlessLowerBound(data.begin(), data.end(), value) == expected && "Lower bound error");
+
+                const auto found = expected != data.end() && *expected == value ? expected : data.end();
+                assert(binarySearch(data.begin(), data.end(), value) == found && "Binary search error");
+            }
+        }
+
+        std::cout << "Passed binary search" << std::endl;
+    }
+
+    void eytzingerTest() const
+    {
+        std::mt19937 rng(4);
+
+        for (int size = 0; size < 300; ++size)
+        {
+            std::vector<int> data(size);
+            std::generate(data.begin(), data.end(), [&]() { return static_cast<int>(rng() % 200); });
+            std::sort(data.begin(), data.end());
+
+            const EytzingerIndex<int> index(data.begin(), data.end());
+            assert(index.size() == data.size() && "Eytzinger size error");
+
+            for (int value = -1; value <= 200; ++value)
+            {
+                const auto expected = std::lower_bound(data.begin(), data.end(), value) - data.begin();
+                assert(index.lowerBound(value) == static_cast<std::size_t>(expected) && "Eytzinger lower bound error");
+                assert(index.contains(value) == std::binary_search(data.begin(), data.end(), value) && "Eytzinger contains error");
+            }
+        }
+
+        std::cout << "Passed Eytzinger index" << std::endl;
+    }
+
+    void batchSearchTest() const
+    {
+        std::mt19937 rng(5);
+
+        for (int size = 0; size < 300; size += 7)
+        {
+            std::vector<int> data(size);
+            std::generate(data.begin(), data.end(), [&]() { return static_cast<int>(rng() % 200); });
+            std::sort(data.begin(), data.end());
+            const std::list<int> list(data.begin(), data.end());
+
+            std::vector<int> queries(rng() % 100);
+            std::generate(queries.begin(), queries.end(), [&]() { return static_cast<int>(rng() % 220) - 10; });
+
+            for (int sorted = 0; sorted < 2; ++sorted)
+            {
+                if (sorted)
+                    std::sort(queries.begin(), queries.end());
+
+                const auto result = batchBinarySearch(data.begin(), data.end(), queries.begin(), queries.end());
+                const auto listResult = batchBinarySearch(list.begin(), list.end(), queries.begin(), queries.end());
+                assert(result.size() == queries.size() && listResult.size() == queries.size() && "Batch search size error");
+
+                for (std::size_t i = 0; i < queries.size(); ++i)
+                {
+                    assert(result[i] == binarySearch(data.begin(), data.end(), queries[i]) && "Batch search error");
+                    assert(listResult[i] == binarySearch(list.begin(), list.end(), queries[i]) && "Batch list search error");
+                }
+            }
+        }
+
+        std::cout << "Passed batch search" << std::endl;
+    }
+
+    // Uniform, skewed and constant data and keys at the limits of the type.
+    template <typename T>
+    void interpolationSearchTest() const
+    {
+        std::mt19937 rng(6);
+
+        for (int size = 0; size < 300; ++size)
+        {
+            std::vector<T> data(size);
+            const auto pattern = size % 3;
+
+            for (auto& element : data)
+            {
+                if (pattern == 0)
+                    element = static_cast<T>(rng() % 1000);
+                else if (pattern == 1)
+                    element = static_cast<T>(std::pow(rng() % 40, 5));
+                else
+                    element = static_cast<T>(7);
+            }
+
+            if (size > 2)
+            {
+                data.front() = std::numeric_limits<T>::lowest();
+                data.back() = std::numeric_limits<T>::max();
+            }
+
+            std::sort(data.begin(), data.end());
+
+            for (int i = 0; i < 100; ++i)
+            {
+                const auto value = i % 2 == 0 && size > 0 ? data[rng() % size] : static_cast<T>(rng() % 1000);
+                assert(interpolationSearch(data.begin(), data.end(), value) == binarySearch(data.begin(), data.end(), value) && "Interpolation search error");
+            }
+
+            for (auto value : { std::numeric_limits<T>::lowest(), std::numeric_limits<T>::max() })
+                assert(interpolationSearch(data.begin(), data.end(), value) == binarySearch(data.begin(), data.end(), value) && "Interpolation search limits error");
+        }
+
+        std::cout << "Passed interpolation search" << std::endl;
+    }
+};
+
+} // namespace search
+
+int main()
+{
+    search::SearcherTester().fullTest();
+
+    return 0;
+}
@@ -1,9 +1,13 @@
 #include <cassert>
+#include <cstdio>
 #include <functional>
 #include <iostream>
+#include <random>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
+#include "../sequence/ExternalSorter.hpp"
 #include "../sequence/Sorter.hpp"
 
 namespace sort
@@ -25,6 +29,27 @@ public:
         sortTest<It, T, Compare>("quick", quickSort<It, Compare>, data);
         sortTest<It, T, Compare>("merge", mergeSort<It, Compare>, data);
         sortTest<It, T, Compare>("heap", heapSort<It, Compare>, data);
+        sortTest<It, T, Compare>("intro", introSort<It, Compare>, data);
+        sortTest<It, T, Compare>("pdq", pdqSort<It, Compare>, data);
+        sortTest<It, T, Compare>("tim", [](It first, It last, Compare cmp) { timSort(first, last, cmp); }, data);
+
+        std::vector<int> large(200000);
+        std::mt19937 rng(42);
+        std::generate(large.begin(), large.end(), [&]() { return static_cast<int>(rng() % 1000); });
+
+        sortTest<It, T, Compare>("parallel quick", [](It first, It last, Compare cmp) { parallelQuickSort(first, last, cmp, 4); }, large);
+        sortTest<It, T, Compare>("parallel merge", [](It first, It last, Compare cmp) { parallelMergeSort(first, last, cmp, 4); }, large);
+
+        patternTest<It, T, Compare>("intro", introSort<It, Compare>);
+        patternTest<It, T, Compare>("pdq", pdqSort<It, Compare>);
+        sortTest<It, T, Compare>("pdq", pdqSort<It, Compare>, large);
+        patternTest<It, T, Compare>("tim", [](It first, It last, Compare cmp) { timSort(first, last, cmp); });
+        sortTest<It, T, Compare>("tim", [](It first, It last, Compare cmp) { timSort(first, last, cmp); }, large);
+        stabilityTest();
+
+        radixTest();
+        externalTest();
+        externalFileTest();
 
         std::cout << "Passed all tests" << std::endl;
     }
@@ -32,10 +57,183 @@ public:
     template <typename It, typename T, typename Compare>
     void sortTest(const std::string& type, std::function<void(It, It, Compare)> sort, T data, Compare cmp = Compare{}) const
     {
+        auto expected = data;
+        std::sort(expected.begin(), expected.end(), cmp);
+
         sort(data.begin(), data.end(), cmp);
-        assert(std::is_sorted(data.begin(), data.end(), cmp) && "Sort error");
+        assert(data == expected && "Sort error");
         std::cout << "Passed " << type << " sort" << std::endl;
     }
+
+    void radixTest() const
+    {
+        std::mt19937_64 rng(7);
+        std::vector<int> ints(50000);
+        std::vector<long long> longs(50000);
+        std::vector<std::string> strings(5000);
+
+        std::generate(ints.begin(), ints.end(), [&]() { return static_cast<int>(rng()); });
+        std::generate(longs.begin(), longs.end(), [&]() { return static_cast<long long>(rng()); });
+        std::generate(strings.begin(), strings.end(), [&]() { return std::to_string(rng() % 100000); });
+
+        auto ints8 = ints;
+        auto ints11 = ints;
+        auto ints16 = ints;
+        auto sortedLongs = longs;
+        auto sortedStrings = strings;
+        radixSort<8>(ints8.begin(), ints8.end());
+        radixSort<11>(ints11.begin(), ints11.end());
+        radixSort<16>(ints16.begin(), ints16.end());
+        radixSort(sortedLongs.begin(), sortedLongs.end());
+        radixSort(sortedStrings.begin(), sortedStrings.end());
+
+        std::sort(ints.begin(), ints.end());
+        std::sort(longs.begin(), longs.end());
+        std::sort(strings.begin(), strings.end());
+        assert(ints8 == ints && ints11 == ints && ints16 == ints && "Sort error");
+        assert(sortedLongs == longs && "Sort error");
+        assert(sortedStrings == strings && "Sort error");
+
+        std::vector<std::pair<unsigned, int>> pairs(1000);
+        for (int i = 0; i < 1000; ++i)
+            pairs[i] = { static_cast<unsigned>(rng() % 10), static_cast<int>(rng() % 1000) };
+
+        auto expected = pairs;
+        std::stable_sort(expected.begin(), expected.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+        radixSort(pairs.begin(), pairs.end(), [](const auto& element) { return element.first; });
+        assert(pairs == expected && "Stability error");
+
+        std::cout << "Passed radix sort" << std::endl;
+    }
+
+    // Only the keys are compared and the payloads are random, so any reordering of equal keys shows
+    // up as a difference from std::stable_sort. The parallel merge sort is run with 2 and 4 threads,
+    // whose leaves are sorted into the buffer and in place.
+    void stabilityTest() const
+    {
+        std::mt19937 rng(11);
+        std::vector<std::pair<int, int>> data(300000);
+        for (auto& element : data)
+            element = { static_cast<int>(rng() % 100), static_cast<int>(rng()) };
+
+        const auto byKey = [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; };
+        auto expected = data;
+        std::stable_sort(expected.begin(), expected.end(), byKey);
+
+        auto timSorted = data;
+        std::vector<std::pair<int, int>> buffer;
+        timSort(timSorted.begin(), timSorted.end(), buffer, byKey);
+        assert(timSorted == expected && "Stability error");
+        std::cout << "Passed tim sort stability" << std::endl;
+
+        for (std::size_t threads : { 2, 4 })
+        {
+            auto mergeSorted = data;
+            parallelMergeSort(mergeSorted.begin(), mergeSorted.end(), byKey, threads);
+            assert(mergeSorted == expected && "Stability error");
+        }
+        std::cout << "Passed parallel merge sort stability" << std::endl;
+    }
+
+    void externalTest() const
+    {
+        std::mt19937 rng(13);
+        std::vector<int> data(100000);
+        std::generate(data.begin(), data.end(), [&]() { return static_cast<int>(rng()); });
+
+        std::vector<int> result;
+        externalSort<int>(data.begin(), data.end(), std::back_inserter(result), 16 * 1024); // 25 runs, merged 4 at a time in 3 passes
+
+        std::vector<int> spilled;
+        externalSort<int>(data.begin(), data.end(), std::back_inserter(spilled), 16 * 1024, std::less<>{}, ".");
+
+        bool rejected = false;
+        try
+        {
+            externalSort<int>(data.begin(), data.end(), std::back_inserter(spilled), 16 * 1024, std::less<>{}, "./missing_spill_directory");
+        }
+        catch (const std::runtime_error&)
+        {
+            rejected = true;
+        }
+
+        std::sort(data.begin(), data.end());
+        assert(result == data && spilled == data && "Sort error");
+        assert(rejected && "Spill directory error");
+        std::cout << "Passed external sort" << std::endl;
+    }
+
+    void externalFileTest() const
+    {
+        const std::string inputPath = "external_sort_input.bin";
+        const std::string outputPath = "external_sort_output.bin";
+
+        std::mt19937 rng(17);
+        std::vector<int> data(50000);
+        std::generate(data.begin(), data.end(), [&]() { return static_cast<int>(rng()); });
+
+        std::FILE* file = std::fopen(inputPath.c_str(), "wb");
+        std::fwrite(data.data(), sizeof(int), data.size(), file);
+        std::fclose(file);
+
+        externalSort<int>(inputPath, outputPath, 16 * 1024);
+
+        std::vector<int> result(data.size() + 1);
+        file = std::fopen(outputPath.c_str(), "rb");
+        result.resize(std::fread(result.data(), sizeof(int), result.size(), file));
+        std::fclose(file);
+
+        std::sort(data.begin(), data.end());
+        assert(result == data && "Sort error");
+
+        // A truncated record is rejected instead of being dropped.
+        file = std::fopen(inputPath.c_str(), "ab");
+        std::fputc(0, file);
+        std::fclose(file);
+
+        bool rejected = false;
+        try
+        {
+            externalSort<int>(inputPath, outputPath, 16 * 1024);
+        }
+        catch (const std::runtime_error&)
+        {
+            rejected = true;
+        }
+
+        std::remove(inputPath.c_str());
+        std::remove(outputPath.c_str());
+
+        assert(rejected && "Partial record error");
+        std::cout << "Passed external file sort" << std::endl;
+    }
+
+    // Inputs which are known to push naive quick sort to quadratic time.
+    template <typename It, typename T, typename Compare>
+    void patternTest(const std::string& type, std::function<void(It, It, Compare)> sort, Compare cmp = Compare{}) const
+    {
+        const int size = 100000;
+        T sorted(size), reversed(size), organPipe(size), equal(size, 7), sawtooth(size);
+
+        for (int i = 0; i < size; ++i)
+        {
+            sorted[i] = i;
+            reversed[i] = size - i;
+            organPipe[i] = i < size / 2 ? i : size - i;
+            sawtooth[i] = i % 64;
+        }
+
+        for (auto data : { sorted, reversed, organPipe, equal, sawtooth })
+        {
+            auto expected = data;
+            std::sort(expected.begin(), expected.end(), cmp);
+
+            sort(data.begin(), data.end(), cmp);
+            assert(data == expected && "Sort error");
+        }
+
+        std::cout << "Passed " << type << " sort patterns" << std::endl;
+    }
 };
 
 } // namespace sort
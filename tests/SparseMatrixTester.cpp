@@ -0,0 +1,188 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../math/SparseMatrix.hpp"
+
+class SparseMatrixTester
+{
+public:
+    void fullTest() const
+    {
+        conversionTest();
+        entriesTest();
+        transposeTest();
+        vectorMultiplicationTest();
+        multiplicationTest();
+        wideMultiplicationTest();
+        parallelMultiplicationTest();
+
+        std::cout << "Passed all tests" << std::endl;
+    }
+
+    void conversionTest() const
+    {
+        Matrix m = { { 0, 2, 0 }, { 1, 0, 0 }, { 0, 0, 0 }, { 4, 0, 5 } };
+
+        for (auto format : { SparseMatrix::Format::Csr, SparseMatrix::Format::Csc })
+        {
+            SparseMatrix s(m, format);
+
+            assert(s.nonZeroCnt() == 4 && "Conversion count error");
+            assert(s.at(3, 2) == 5 && s.at(2, 1) == 0 && "Conversion access error");
+            assert(s.toMatrix() == m && "Conversion error");
+            assert(s.toFormat(SparseMatrix::Format::Csr).toMatrix() == m && "Format conversion error");
+            assert(s.toFormat(SparseMatrix::Format::Csc).toMatrix() == m && "Format conversion error");
+        }
+
+        std::cout << "Passed conversion" << std::endl;
+    }
+
+    void entriesTest() const
+    {
+        SparseMatrix s(2, 3, { { 1, 2, 1.5 }, { 0, 0, 1 }, { 1, 2, 2 }, { 1, 0, -1 } });
+        Matrix expected = { { 1, 0, 0 }, { -1, 0, 3.5 } };
+
+        assert(s.nonZeroCnt() == 3 && "Duplicate entries error");
+        assert(s.toMatrix() == expected && "Entries error");
+        std::cout << "Passed entries" << std::endl;
+    }
+
+    void transposeTest() const
+    {
+        Matrix m = { { 6, 0, 24 }, { 0, -9, 0 } };
+        Matrix expected = { { 6, 0 }, { 0, -9 }, { 24, 0 } };
+
+        SparseMatrix s(m);
+        auto result = s.transpose();
+
+        assert(result.toMatrix() == expected && "Transpose error");
+        assert(result.toFormat(SparseMatrix::Format::Csr).toMatrix() == expected && "Transpose conversion error");
+        std::cout << "Passed transpose" << std::endl;
+    }
+
+    void vectorMultiplicationTest() const
+    {
+        auto a = randomMatrix(300, 200, 1);
+        std::vector<double> x(200);
+        for (std::size_t j = 0; j < x.size(); ++j)
+            x[j] = j % 7 - 3.0;
+
+        for (auto format : { SparseMatrix::Format::Csr, SparseMatrix::Format::Csc })
+        {
+            auto result = SparseMatrix(a, format) * x;
+
+            for (std::size_t i = 0; i < 300; ++i)
+            {
+                double expected = 0;
+                for (std::size_t j = 0; j < 200; ++j)
+                    expected += a[i][j] * x[j];
+
+                assert(std::abs(result[i] - expected) < 1e-9 && "Vector multiplication error");
+            }
+        }
+
+        std::cout << "Passed vector multiplication" << std::endl;
+    }
+
+    void multiplicationTest() const
+    {
+        auto a = randomMatrix(120, 90, 2);
+        auto b = randomMatrix(90, 150, 3);
+        Matrix expected = a * b;
+
+        auto result = SparseMatrix(a) * SparseMatrix(b, SparseMatrix::Format::Csc);
+
+        assert(result.getRowCnt() == 120 && result.getColCnt() == 150 && "Multiplication dimensions error");
+        assert(result.toMatrix() == expected && "Multiplication error");
+        std::cout << "Passed multiplication" << std::endl;
+    }
+
+    // Too wide for the dense accumulator. The product of the transposes is narrow, so it is computed
+    // by the dense accumulator and must hold the same elements.
+    void wideMultiplicationTest() const
+    {
+        const std::size_t wide = (1 << 20) + 3;
+        SparseMatrix a(2, 3, { { 0, 0, 1 }, { 0, 2, 2 }, { 1, 1, -3 } });
+        SparseMatrix b(3, wide, { { 0, 5, 2 }, { 0, wide - 1, 1 }, { 1, 5, 4 }, { 2, 5, 1 }, { 2, 0, 7 }, { 2, wide - 1, -0.5 } });
+
+        const auto result = a * b;
+        assert(result.nonZeroCnt() == 4 && result.at(0, 5) == 4 && result.at(0, 0) == 14 && result.at(0, wide - 1) == 0 &&
+            result.at(1, 5) == -12 && "Wide multiplication error");
+
+        const auto transposed = (b.transpose() * a.transpose()).transpose().toFormat(SparseMatrix::Format::Csr);
+        assert(result.print() == transposed.print() && "Wide multiplication error");
+
+        std::cout << "Passed wide multiplication" << std::endl;
+    }
+
+    // Enough stored elements for several threads, so the rows are split into parts whose results
+    // are merged. Every row is computed the same way by one thread, so the results must be equal.
+    void parallelMultiplicationTest() const
+    {
+        const auto a = randomEntries(3000, 2000, 150000, 4);
+        const auto b = randomEntries(2000, 500, 10000, 5);
+        SparseMatrix sa(3000, 2000, a);
+        SparseMatrix sb(2000, 500, b, SparseMatrix::Format::Csc);
+        assert(sa.nonZeroCnt() > 2 * (1 << 16) && "Parallel multiplication setup error");
+
+        std::vector<double> x(2000);
+        for (std::size_t j = 0; j < x.size(); ++j)
+            x[j] = j % 7 - 3.0;
+
+        std::vector<double> expected(3000, 0);
+        for (const auto& [i, j, value] : a)
+            expected[i] += value * x[j];
+
+        const auto result = sa.multiply(x, 4);
+        const auto columnResult = sa.toFormat(SparseMatrix::Format::Csc).multiply(x, 4);
+        for (std::size_t i = 0; i < 3000; ++i)
+        {
+            assert(std::abs(result[i] - expected[i]) < 1e-9 && "Parallel vector multiplication error");
+            assert(std::abs(columnResult[i] - expected[i]) < 1e-9 && "Parallel CSC vector multiplication error");
+        }
+
+        const auto product = sa.multiply(sb, 4);
+        const auto sequential = sa.multiply(sb, 1);
+        assert(product.nonZeroCnt() == sequential.nonZeroCnt() && "Parallel multiplication error");
+        assert(product.toMatrix() == sequential.toMatrix() && "Parallel multiplication error");
+
+        std::cout << "Passed parallel multiplication" << std::endl;
+    }
+
+private:
+    static auto randomEntries(std::size_t rowCnt, std::size_t colCnt, std::size_t count, unsigned seed) -> std::vector<SparseMatrix::Entry>
+    {
+        std::mt19937 rng(seed);
+        std::vector<SparseMatrix::Entry> entries(count);
+
+        for (auto& entry : entries)
+            entry = { rng() % rowCnt, rng() % colCnt, static_cast<double>(rng() % 19) - 9 };
+
+        return entries;
+    }
+
+    // About 5 % of the elements are non-zero.
+    static auto randomMatrix(std::size_t rowCnt, std::size_t colCnt, unsigned seed) -> Matrix
+    {
+        std::mt19937 rng(seed);
+        Matrix result(rowCnt, colCnt);
+
+        for (std::size_t i = 0; i < rowCnt; ++i)
+        {
+            for (std::size_t j = 0; j < colCnt; ++j)
+                result[i][j] = rng() % 20 == 0 ? static_cast<double>(rng() % 19) - 9 : 0;
+        }
+
+        return result;
+    }
+};
+
+int main()
+{
+    SparseMatrixTester().fullTest();
+
+    return 0;
+}